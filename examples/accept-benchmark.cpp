@@ -0,0 +1,139 @@
+// examples/accept-benchmark.cpp                                      -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+// Measures the accept throughput of an io_context_pool with one reuse_port
+// acceptor per context for increasing numbers of contexts. The load is
+// generated by blocking client threads which connect and immediately reset
+// the connection. The acceptors either use a loop of async_accept() or one
+// async_accept_each() which keeps the accept operation armed.
+
+#include <stdnet/io_context_pool.hpp>
+#include <stdnet/socket.hpp>
+#include <stdnet/internet.hpp>
+#include <exec/async_scope.hpp>
+#include <exec/task.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+// ----------------------------------------------------------------------------
+
+constexpr std::uint16_t port{12346};
+
+auto get_backend(int ac, char* av[]) -> stdnet::io_context::backend
+{
+    std::string_view name(1 < ac? av[1]: "libevent");
+    return name == "poll"?  stdnet::io_context::backend::poll
+        :  name == "epoll"? stdnet::io_context::backend::epoll
+        :  name == "uring"? stdnet::io_context::backend::uring
+        :                   stdnet::io_context::backend::libevent
+        ;
+}
+
+auto accept_loop(stdnet::io_context& context, std::atomic<std::size_t>& accepted) -> exec::task<void>
+{
+    stdnet::ip::tcp::endpoint endpoint(stdnet::ip::address_v4::any(), port);
+    stdnet::ip::tcp::acceptor acceptor(context, endpoint, true, true);
+    while (true)
+    {
+        // The accepted stream is closed right away.
+        co_await stdnet::async_accept(acceptor);
+        accepted.fetch_add(1u, std::memory_order_relaxed);
+    }
+}
+
+auto accept_each(stdnet::io_context& context, std::atomic<std::size_t>& accepted) -> exec::task<void>
+{
+    stdnet::ip::tcp::endpoint endpoint(stdnet::ip::address_v4::any(), port);
+    stdnet::ip::tcp::acceptor acceptor(context, endpoint, true, true);
+    co_await stdnet::async_accept_each(acceptor, [&accepted](auto&&, auto&&){
+        accepted.fetch_add(1u, std::memory_order_relaxed);
+    });
+}
+
+void connect_loop(std::atomic<bool> const& done)
+{
+    ::sockaddr_in address{};
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::linger reset{1, 0};
+
+    while (not done.load(std::memory_order_relaxed))
+    {
+        int fd(::socket(AF_INET, SOCK_STREAM, 0));
+        ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+        ::connect(fd, reinterpret_cast<::sockaddr*>(&address), sizeof(address));
+        ::close(fd);
+    }
+}
+
+auto measure(std::size_t size, stdnet::io_context::backend backend, std::size_t clients, bool each) -> double
+{
+    stdnet::io_context_pool   pool(size, backend);
+    exec::async_scope         scope;
+    std::atomic<std::size_t>  accepted{};
+    std::atomic<bool>         done{false};
+
+    for (std::size_t i{}; i != pool.size(); ++i)
+        scope.spawn((each? accept_each(pool[i], accepted): accept_loop(pool[i], accepted))
+                    | stdexec::upon_error([](auto){}));
+
+    std::jthread server([&pool]{ pool.run(); });
+    auto start{std::chrono::steady_clock::now()};
+    {
+        std::vector<std::jthread> load;
+        for (std::size_t i{}; i != clients; ++i)
+            load.emplace_back([&done]{ connect_loop(done); });
+        std::this_thread::sleep_for(2s);
+        done = true;
+    }
+    std::chrono::duration<double> elapsed(std::chrono::steady_clock::now() - start);
+    scope.request_stop();
+
+    return accepted.load() / elapsed.count();
+}
+
+int main(int ac, char* av[])
+{
+    auto backend{get_backend(ac, av)};
+    std::size_t cores{std::max(1u, std::thread::hardware_concurrency())};
+    std::size_t clients{2u * cores};
+
+    std::cout << "contexts  loop accepts/s  each accepts/s\n";
+    for (std::size_t size{1u}; size <= cores; size *= 2u)
+    {
+        std::cout << std::setw(8) << size << "  "
+                  << std::setw(14) << std::fixed << std::setprecision(0) << measure(size, backend, clients, false)
+                  << "  "
+                  << std::setw(14) << std::fixed << std::setprecision(0) << measure(size, backend, clients, true)
+                  << "\n";
+    }
+}
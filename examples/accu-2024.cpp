@@ -34,9 +34,9 @@
 #include <cstddef>
 #include <exception>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <ranges>
 #include <span>
 #include <sstream>
@@ -47,6 +47,10 @@
 #include <utility>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace std::chrono_literals;
 using namespace std::string_view_literals;
 
@@ -71,13 +75,33 @@ auto send_response(auto& stream, std::string head, std::string body)
         << body;
 
     return stdexec::just() | stdexec::let_value([data = out.str(), &stream]()mutable noexcept {
-        return stdnet::async_send(stream, stdnet::buffer(data))
+        return stdnet::async_write_all(stream, stdnet::buffer(data))
              ;
         }
     )
     ;
 }
 
+exec::task<bool> send_file(auto& stream, std::string const& path)
+{
+    int fd(::open(path.c_str(), O_RDONLY));
+    if (fd < 0)
+        co_return false;
+    std::unique_ptr<int, decltype([](int* fd){ ::close(*fd); })> close(&fd);
+    struct ::stat st{};
+    if (::fstat(fd, &st) < 0)
+        co_return false;
+
+    std::ostringstream out;
+    out << "HTTP/1.1 200 OK\r\n"
+        << "Content-Length: " << st.st_size << "\r\n"
+        << "\r\n";
+    std::string head(out.str());
+    co_await stdnet::async_write_all(stream, stdnet::buffer(head));
+    co_await stdnet::async_sendfile(stream, fd, 0, std::size_t(st.st_size));
+    co_return true;
+}
+
 std::unordered_map<std::string, std::string> data{
     {"/", "data/hello.html" },
     {"fav.png", "data/fav.png" }
@@ -102,10 +126,10 @@ exec::task<void> make_client(auto stream, bool& keep_running)
             {
                 if (method == "GET" && data.contains(url))
                 {
-                    std::ifstream in(data[url]);
-                    co_await send_response(stream, "200 OK",
-                         std::string(std::istreambuf_iterator<char>(in), {}))
-                         ;
+                    if (!co_await send_file(stream, data[url]))
+                    {
+                        co_await send_response(stream, "404 not found", "");
+                    }
                 }
                 else if (method == "GET" && url == "/exit")
                 {
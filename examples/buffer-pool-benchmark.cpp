@@ -0,0 +1,99 @@
+// examples/buffer-pool-benchmark.cpp                                 -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+// Measures the cost of getting a request buffer: each simulated request
+// obtains a 16 KiB buffer, touches it, and keeps it while a few other
+// requests are in flight. The buffers are either std::vector<char>s, i.e.,
+// what the examples allocate per request, or leased from a buffer_pool
+// shared by all threads.
+
+#include <stdnet/buffer_pool.hpp>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+    constexpr std::size_t buffer_size{16384u};
+    constexpr std::size_t in_flight{16u};
+
+    struct vector_source
+    {
+        auto get() { return std::vector<char>(buffer_size); }
+    };
+
+    struct pool_source
+    {
+        stdnet::buffer_pool pool{buffer_size};
+        auto get() { return pool.lease(); }
+    };
+
+    template <typename Source>
+    auto measure(std::string_view name, std::size_t threads, std::size_t requests) -> void
+    {
+        Source source;
+        auto start(std::chrono::steady_clock::now());
+        std::vector<std::thread> workers;
+        for (std::size_t t{}; t != threads; ++t)
+        {
+            workers.emplace_back([&source, requests]{
+                std::vector<decltype(source.get())> active(in_flight);
+                for (std::size_t i{}; i != requests; ++i)
+                {
+                    auto& slot(active[i % in_flight]);
+                    slot = source.get();
+                    slot.data()[0] = char(i);
+                    slot.data()[buffer_size - 1u] = char(i);
+                }
+            });
+        }
+        for (auto& worker: workers)
+        {
+            worker.join();
+        }
+        auto end(std::chrono::steady_clock::now());
+
+        std::cout << std::setw(10) << name << std::setw(10) << threads
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(14) << std::chrono::duration<double, std::nano>(end - start).count() / (threads * requests)
+                  << "\n";
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int ac, char* av[])
+{
+    std::size_t requests(1 < ac? std::stoul(av[1]): 1'000'000u);
+
+    std::cout << std::setw(10) << "buffers" << std::setw(10) << "threads"
+              << std::setw(14) << "ns/request" << "\n";
+    for (std::size_t threads: {1u, 4u, 16u})
+    {
+        measure<vector_source>("vector", threads, requests);
+        measure<pool_source>("pool", threads, requests);
+    }
+}
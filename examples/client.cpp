@@ -27,13 +27,24 @@
 #include <exec/task.hpp>
 #include <functional>
 #include <iostream>
+#include <string_view>
 
 // ----------------------------------------------------------------------------
 
-int main()
+auto get_backend(int ac, char* av[]) -> stdnet::io_context::backend
+{
+    std::string_view name(1 < ac? av[1]: "libevent");
+    return name == "poll"?  stdnet::io_context::backend::poll
+        :  name == "epoll"? stdnet::io_context::backend::epoll
+        :  name == "uring"? stdnet::io_context::backend::uring
+        :                   stdnet::io_context::backend::libevent
+        ;
+}
+
+int main(int ac, char* av[])
 {
     using stream_socket = stdnet::basic_stream_socket<stdnet::ip::tcp>;
-    stdnet::io_context context;
+    stdnet::io_context context(get_backend(ac, av));
     exec::async_scope scope;
     scope.spawn(std::invoke([](auto& context)->exec::task<void> {
         try
@@ -0,0 +1,139 @@
+// examples/container-benchmark.cpp                                   -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+// Measures the cost of the operations on the socket records of a context:
+// a number of sockets is inserted, looked up in random order, and erased in
+// random order. The native handle is looked up separately as it is the only
+// part needed when an operation is actually performed. The _Container is compared to a vector of
+// variants with an embedded free list, i.e., the layout it replaced.
+
+#include <stdnet/container.hpp>
+#include <stdnet/epoll_context.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+    using record = stdnet::_Hidden::_Epoll_record;
+    using id     = stdnet::_Hidden::_Socket_id;
+
+    class variant_container
+    {
+    private:
+        struct entry
+        {
+            stdnet::_Stdnet_native_handle_type handle;
+            record                             rec;
+        };
+        std::vector<std::variant<std::size_t, entry>> records;
+        std::size_t                                   free{};
+
+    public:
+        auto _Insert(stdnet::_Stdnet_native_handle_type handle) -> id
+        {
+            if (this->free == this->records.size())
+            {
+                this->records.emplace_back(std::in_place_type<entry>, handle);
+                return id(this->free++);
+            }
+            std::size_t index(std::exchange(this->free, std::get<0>(this->records[this->free])));
+            this->records[index].emplace<entry>(handle);
+            return id(index);
+        }
+        auto _Erase(id i) -> void { this->records[std::size_t(i)] = std::exchange(this->free, std::size_t(i)); }
+        auto _Handle(id i) -> stdnet::_Stdnet_native_handle_type { return std::get<1>(this->records[std::size_t(i)]).handle; }
+        auto operator[](id i) -> record& { return std::get<1>(this->records[std::size_t(i)]).rec; }
+    };
+
+    template <typename Container>
+    auto measure(std::string_view name, std::size_t size) -> void
+    {
+        Container                container;
+        std::vector<id>          ids;
+        std::mt19937             rng(17);
+        std::vector<std::size_t> order(size);
+        std::iota(order.begin(), order.end(), 0u);
+        std::shuffle(order.begin(), order.end(), rng);
+        ids.reserve(size);
+
+        auto start(std::chrono::steady_clock::now());
+        for (std::size_t i{}; i != size; ++i)
+        {
+            ids.push_back(container._Insert(stdnet::_Stdnet_native_handle_type(i)));
+        }
+        auto inserted(std::chrono::steady_clock::now());
+        long sum{};
+        for (std::size_t i: order)
+        {
+            sum += container._Handle(ids[i]);
+        }
+        auto handles(std::chrono::steady_clock::now());
+        for (std::size_t i: order)
+        {
+            record& rec(container[ids[i]]);
+            sum += rec._Blocking + rec._Speculative;
+        }
+        auto looked_up(std::chrono::steady_clock::now());
+        for (std::size_t i: order)
+        {
+            container._Erase(ids[i]);
+        }
+        auto end(std::chrono::steady_clock::now());
+
+        auto per_socket = [size](auto duration){
+            return std::chrono::duration<double, std::nano>(duration).count() / size;
+        };
+        std::cout << std::setw(10) << name << std::setw(10) << size
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << per_socket(inserted - start)
+                  << std::setw(12) << per_socket(handles - inserted)
+                  << std::setw(12) << per_socket(looked_up - handles)
+                  << std::setw(12) << per_socket(end - looked_up)
+                  << (sum < 0? " (overflow)": "") << "\n";
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int ac, char* av[])
+{
+    std::size_t size(1 < ac? std::stoul(av[1]): 1'000'000u);
+
+    std::cout << std::setw(10) << "layout" << std::setw(10) << "sockets"
+              << std::setw(12) << "insert ns" << std::setw(12) << "handle ns"
+              << std::setw(12) << "record ns"
+              << std::setw(12) << "erase ns" << "\n";
+    for (int round{}; round != 2; ++round)
+    {
+        measure<variant_container>("variant", size);
+        measure<stdnet::_Hidden::_Container<record>>("slot map", size);
+    }
+}
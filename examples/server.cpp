@@ -54,7 +54,7 @@ auto make_client(exec::async_scope& scope, auto client) -> exec::task<void>
                 std::cout << "exiting\n";
                 scope.get_stop_source().request_stop();
             }
-            auto ssize = co_await stdnet::async_send(client, ::stdnet::mutable_buffer(buffer, size));
+            auto ssize = co_await stdnet::async_write_all(client, ::stdnet::mutable_buffer(buffer, size));
             std::cout << "sent<ssize>(" << ::std::string_view(buffer, ssize) << ")\n";
         }
         std::cout << "client done\n";
@@ -66,14 +66,24 @@ auto make_client(exec::async_scope& scope, auto client) -> exec::task<void>
     
 }
 
-int main()
+auto get_backend(int ac, char* av[]) -> stdnet::io_context::backend
+{
+    std::string_view name(1 < ac? av[1]: "libevent");
+    return name == "poll"?  stdnet::io_context::backend::poll
+        :  name == "epoll"? stdnet::io_context::backend::epoll
+        :  name == "uring"? stdnet::io_context::backend::uring
+        :                   stdnet::io_context::backend::libevent
+        ;
+}
+
+int main(int ac, char* av[])
 {
     std::cout << std::unitbuf;
     std::cout << "example server\n";
     try
     {
         exec::async_scope         scope;
-        stdnet::io_context        context;
+        stdnet::io_context        context(get_backend(ac, av));
         stdnet::ip::tcp::endpoint endpoint(stdnet::ip::address_v4::any(), 12345);
         stdnet::ip::tcp::acceptor acceptor(context, endpoint);
 
@@ -17,9 +17,11 @@
 //
 // ----------------------------------------------------------------------------
 
+#include <stdnet/io_context_pool.hpp>
 #include <stdnet/socket.hpp>
 #include <stdnet/internet.hpp>
 #include <stdnet/buffer.hpp>
+#include <stdnet/dynamic_buffer.hpp>
 #include <stdnet/timer.hpp>
 #include <exec/async_scope.hpp>
 #include <exec/when_any.hpp>
@@ -27,10 +29,13 @@
 #include <algorithm>
 #include <exception>
 #include <iostream>
-#include <fstream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <ranges>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std::chrono_literals;
 using namespace std::string_view_literals;
@@ -67,32 +72,19 @@ struct parser
 template <typename Stream>
 struct buffered_stream
 {
-    static constexpr char sep[]{ '\r', '\n', '\r', '\n', '\0' };
-    Stream            stream;
-    std::vector<char> buffer = std::vector<char>(1024u);
-    std::size_t       pos{};
-    std::size_t       end{};
+    Stream                 stream;
+    stdnet::dynamic_buffer buffer{1u << 16};
+    std::size_t            pos{};
 
     void consume()
     {
-        buffer.erase(buffer.begin(), buffer.begin() + pos);
-        end -= pos;
+        buffer.consume(pos);
         pos = 0;
     }
     auto read_head() -> exec::task<std::string_view>
     {
-        while (true)
-        {
-            if (buffer.size() == end)
-                buffer.resize(buffer.size() * 2);
-            auto n = co_await stdnet::async_receive(stream, stdnet::buffer(buffer.data() + end, buffer.size() - end));
-            if (n == 0u)
-                co_return {};
-            end += n;
-            pos = std::string_view(buffer.data(), end).find(sep);
-            if (pos != std::string_view::npos)
-                co_return {buffer.data(), pos += std::size(sep) - 1};
-        }
+        pos = co_await stdnet::async_read_until(stream, buffer, "\r\n\r\n"sv);
+        co_return {buffer.view().data(), pos};
     }
     auto write_response(std::string_view message, std::string_view response) -> exec::task<void>
     {
@@ -102,15 +94,27 @@ struct buffered_stream
              << "\r\n"
              ;
         std::string head(out.str());
-        std::size_t p{}, n{};
-        do 
-            n = co_await stdnet::async_send(stream, stdnet::buffer(head.data() + p, head.size() - p));
-        while (0 < n && (p += n) != head.size());
-
-        p = 0;
-        do
-            n = co_await stdnet::async_send(stream, stdnet::buffer(response.data() + p, response.size() - p));
-        while (0 < n && (p += n) != response.size());
+        co_await stdnet::async_write_all(stream, stdnet::buffer_sequence(stdnet::buffer(head), stdnet::buffer(response)));
+    }
+    auto write_file(std::string const& path) -> exec::task<bool>
+    {
+        int fd(::open(path.c_str(), O_RDONLY));
+        if (fd < 0)
+            co_return false;
+        std::unique_ptr<int, decltype([](int* fd){ ::close(*fd); })> close(&fd);
+        struct ::stat st{};
+        if (::fstat(fd, &st) < 0)
+            co_return false;
+
+        std::ostringstream out;
+        out << "HTTP/1.1 200 OK\r\n"
+            << "Content-Length: " << st.st_size << "\r\n"
+            << "\r\n"
+            ;
+        std::string head(out.str());
+        co_await stdnet::async_write_all(stream, stdnet::buffer(head));
+        co_await stdnet::async_sendfile(stream, fd, 0, std::size_t(st.st_size));
+        co_return true;
     }
 };
 
@@ -172,16 +176,10 @@ auto make_client(Stream s) -> exec::task<void>
         {
             auto it = res.find(r.uri);
             std::cout << "getting '" << r.uri << "'->" << (it == res.end()? "404": "OK") << "\n";
-            if (it == res.end())
+            if (it == res.end() || not co_await stream.write_file(it->second))
             {
                 co_await stream.write_response("404 NOT FOUND", "not found");
             }
-            else
-            {
-                std::ifstream in(it->second);
-                std::string res(std::istreambuf_iterator<char>(in), {});
-                co_await stream.write_response("200 OK", res);
-            }
         }
 
         keep_alive = r.headers["Connection"] == "keep-alive"sv;
@@ -191,7 +189,7 @@ auto make_client(Stream s) -> exec::task<void>
 
 auto make_server(auto& context, auto& scope, auto endpoint) -> exec::task<void>
 {
-    stdnet::ip::tcp::acceptor acceptor(context, endpoint);
+    stdnet::ip::tcp::acceptor acceptor(context, endpoint, true, true);
     while (true)
     {
         auto[stream, client] = co_await stdnet::async_accept(acceptor);
@@ -210,13 +208,14 @@ int main()
     std::cout << std::unitbuf;
     try
     {
-        stdnet::io_context        context;
+        stdnet::io_context_pool   pool;
         stdnet::ip::tcp::endpoint endpoint(stdnet::ip::address_v4::any(), 12345);
         exec::async_scope         scope;
 
-        scope.spawn(make_server(context, scope, endpoint));
+        for (std::size_t i{}; i != pool.size(); ++i)
+            scope.spawn(make_server(pool[i], scope, endpoint));
 
-        context.run();
+        pool.run();
     }
     catch (std::exception const& ex)
     {
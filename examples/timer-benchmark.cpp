@@ -0,0 +1,129 @@
+// examples/timer-benchmark.cpp                                       -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+// Measures the cost of arming and cancelling a timer, the typical life of an
+// idle timeout: for each backend a number of timers with timeouts between 10
+// and 60 seconds is armed and all of them are cancelled again.
+
+#include <stdnet/internet.hpp>
+#include <stdnet/io_context.hpp>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+    struct timer
+        : stdnet::_Hidden::_Context_base::_Resume_after_operation
+    {
+        std::size_t* count;
+        timer(std::size_t* count)
+            : stdnet::_Hidden::_Context_base::_Resume_after_operation(stdnet::_Hidden::_Socket_id(), 0)
+            , count(count)
+        {
+        }
+        auto _Complete() -> void override { ++*this->count; }
+        auto _Error(std::error_code) -> void override { ++*this->count; }
+        auto _Cancel() -> void override { ++*this->count; }
+    };
+
+    struct cancellation
+        : stdnet::_Hidden::_Cancel_node
+    {
+        std::size_t* count;
+        cancellation(timer* op, std::size_t* count)
+            : stdnet::_Hidden::_Cancel_node(op, [](stdnet::_Hidden::_Cancel_node* node){
+                ++*static_cast<cancellation*>(node)->count;
+            })
+            , count(count)
+        {
+        }
+    };
+
+    auto measure(std::string_view name, stdnet::io_context::backend backend, std::size_t size) -> void
+    {
+        stdnet::io_context                  context(backend);
+        stdnet::_Hidden::_Context_base&     ctxt(*context.get_scheduler()._Get_context());
+        std::size_t                         count{};
+        std::vector<std::unique_ptr<timer>> timers;
+        std::vector<cancellation>           cancels;
+        std::mt19937                        rng(17);
+        std::uniform_int_distribution<>     timeout(10'000, 60'000);
+
+        for (std::size_t i{}; i != size; ++i)
+        {
+            timers.push_back(std::make_unique<timer>(&count));
+            std::get<0>(*timers.back()) = std::chrono::milliseconds(timeout(rng));
+        }
+
+        auto start(std::chrono::steady_clock::now());
+        for (std::size_t i{}; i != size; ++i)
+        {
+            if (!ctxt._Resume_after(timers[i].get()))
+            {
+                timers[i]->_Complete();
+            }
+        }
+        cancels.reserve(size);
+        for (std::size_t i{}; i != size; ++i)
+        {
+            cancels.emplace_back(timers[i].get(), &count);
+        }
+        auto armed(std::chrono::steady_clock::now());
+        for (std::size_t i{}; i != size; ++i)
+        {
+            ctxt._Cancel(&cancels[i]);
+        }
+        while (count < 2u * size && ctxt.run_one())
+        {
+        }
+        auto end(std::chrono::steady_clock::now());
+
+        auto per_timer = [size](auto duration){
+            return std::chrono::duration<double, std::nano>(duration).count() / size;
+        };
+        std::cout << std::setw(10) << name << std::setw(10) << size
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << per_timer(armed - start)
+                  << std::setw(12) << per_timer(end - armed)
+                  << (count == 2u * size? "": " (incomplete)") << "\n";
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+int main(int ac, char* av[])
+{
+    std::size_t size(1 < ac? std::stoul(av[1]): 100'000u);
+
+    std::cout << std::setw(10) << "backend" << std::setw(10) << "timers"
+              << std::setw(12) << "arm ns" << std::setw(12) << "cancel ns" << "\n";
+    measure("poll", stdnet::io_context::backend::poll, size);
+    measure("epoll", stdnet::io_context::backend::epoll, size);
+    measure("libevent", stdnet::io_context::backend::libevent, size);
+    measure("uring", stdnet::io_context::backend::uring, size);
+}
@@ -0,0 +1,134 @@
+// examples/zerocopy-benchmark.cpp                                    -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+// Measures sending large payloads over a loopback TCP connection using
+// async_write_all() (the payload is copied into the socket buffer) and
+// async_send_zerocopy() (MSG_ZEROCOPY). The receiving side is a thread
+// doing blocking reads. Reported are the throughput and the CPU time of the
+// thread running the context per GB sent. Note that loopback doesn't
+// support zero-copy transmission: the kernel copies the pages when they are
+// received, i.e., the benefit shows on the sending thread only.
+
+#include <stdnet/socket.hpp>
+#include <stdnet/internet.hpp>
+#include <stdnet/buffer.hpp>
+#include <exec/async_scope.hpp>
+#include <exec/task.hpp>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+
+constexpr std::uint16_t port{12347};
+constexpr std::size_t   total{std::size_t(4) << 30};
+
+auto get_backend(std::string_view name) -> stdnet::io_context::backend
+{
+    return name == "poll"?  stdnet::io_context::backend::poll
+        :  name == "epoll"? stdnet::io_context::backend::epoll
+        :  name == "uring"? stdnet::io_context::backend::uring
+        :                   stdnet::io_context::backend::libevent
+        ;
+}
+
+auto thread_cpu() -> double
+{
+    ::rusage usage{};
+    ::getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+        + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+void sink()
+{
+    ::sockaddr_in address{};
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int fd(::socket(AF_INET, SOCK_STREAM, 0));
+    ::connect(fd, reinterpret_cast<::sockaddr*>(&address), sizeof(address));
+    std::vector<char> buffer(1u << 20);
+    while (0 < ::read(fd, buffer.data(), buffer.size()))
+    {
+    }
+    ::close(fd);
+}
+
+auto send(stdnet::ip::tcp::acceptor& acceptor, std::size_t size, bool zerocopy) -> exec::task<void>
+{
+    auto[stream, client] = co_await stdnet::async_accept(acceptor);
+    std::vector<char> payload(size, 'x');
+    for (std::size_t sent{}; sent < total; sent += size)
+    {
+        if (zerocopy)
+            co_await stdnet::async_send_zerocopy(stream, stdnet::buffer(payload));
+        else
+            co_await stdnet::async_write_all(stream, stdnet::buffer(payload));
+    }
+}
+
+auto measure(stdnet::io_context::backend backend, std::size_t size, bool zerocopy) -> void
+{
+    exec::async_scope         scope;
+    stdnet::io_context        context(backend);
+    stdnet::ip::tcp::endpoint endpoint(stdnet::ip::address_v4::any(), port);
+    stdnet::ip::tcp::acceptor acceptor(context, endpoint);
+
+    scope.spawn(send(acceptor, size, zerocopy) | stdexec::upon_error([](auto){}));
+    std::jthread receiver(sink);
+
+    auto   start{std::chrono::steady_clock::now()};
+    double cpu{thread_cpu()};
+    context.run();
+    cpu = thread_cpu() - cpu;
+    std::chrono::duration<double> elapsed(std::chrono::steady_clock::now() - start);
+
+    double gb(total / 1e9);
+    std::cout << std::setw(10) << (zerocopy? "zerocopy": "copy")
+              << std::setw(12) << size
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << gb / elapsed.count()
+              << std::setw(12) << cpu / gb
+              << "\n";
+}
+
+int main(int ac, char* av[])
+{
+    auto backend{get_backend(1 < ac? av[1]: "libevent")};
+
+    std::cout << std::setw(10) << "send" << std::setw(12) << "payload"
+              << std::setw(12) << "GB/s" << std::setw(12) << "cpu s/GB" << "\n";
+    for (std::size_t size: {std::size_t(64) << 10, std::size_t(1) << 20, std::size_t(16) << 20})
+    {
+        measure(backend, size, false);
+        measure(backend, size, true);
+    }
+}
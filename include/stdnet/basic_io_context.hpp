@@ -0,0 +1,207 @@
+// stdnet/basic_io_context.hpp                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+/*
+ * Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_STDNET_BASIC_IO_CONTEXT
+#define INCLUDED_STDNET_BASIC_IO_CONTEXT
+
+#include <stdnet/netfwd.hpp>
+#include <stdnet/context_base.hpp>
+#include <stdnet/internet.hpp>
+#include <stdnet/io_context.hpp>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <csignal>
+
+// ----------------------------------------------------------------------------
+
+namespace stdnet
+{
+    using epoll_context    = ::stdnet::basic_io_context<::stdnet::_Hidden::_Epoll_context>;
+    using libevent_context = ::stdnet::basic_io_context<::stdnet::_Hidden::_Libevent_context>;
+    using poll_context     = ::stdnet::basic_io_context<::stdnet::_Hidden::_Poll_context>;
+    using uring_context    = ::stdnet::basic_io_context<::stdnet::_Hidden::_Uring_context>;
+}
+
+// ----------------------------------------------------------------------------
+// The _Static_scheduler calls the functions of the concrete backend without
+// going through the virtual functions of _Context_base, i.e., submitting an
+// operation can be inlined. The context is only used from the thread running
+// it: operations need to be started and stopped on that thread. There is no
+// hand-over from other threads.
+
+template <typename _Backend>
+class stdnet::_Hidden::_Static_scheduler
+{
+private:
+    _Backend* _D_context;
+
+public:
+    static constexpr bool _Single_threaded{true};
+
+    _Static_scheduler(::stdnet::_Hidden::_Context_base* _Context)
+        : _D_context(static_cast<_Backend*>(_Context))
+    {
+    }
+
+    auto _Get_context() const -> _Backend* { return this->_D_context; }
+
+    auto _Cancel(::stdnet::_Hidden::_Cancel_node* _Node) -> void
+    {
+        this->_D_context->_Backend::_Cancel(_Node);
+    }
+    auto _Accept(::stdnet::_Hidden::_Context_base::_Accept_operation* _Op) -> bool
+    {
+        return this->_D_context->_Backend::_Accept(_Op);
+    }
+    auto _Accept_multishot(::stdnet::_Hidden::_Context_base::_Accept_operation* _Op) -> bool
+    {
+        return this->_D_context->_Backend::_Accept_multishot(_Op);
+    }
+    auto _Connect(::stdnet::_Hidden::_Context_base::_Connect_operation* _Op) -> bool
+    {
+        return this->_D_context->_Backend::_Connect(_Op);
+    }
+    auto _Receive(::stdnet::_Hidden::_Context_base::_Receive_operation* _Op) -> bool
+    {
+        return this->_D_context->_Backend::_Receive(_Op);
+    }
+    auto _Receive_multishot(::stdnet::_Hidden::_Context_base::_Receive_multishot_operation* _Op) -> bool
+    {
+        return this->_D_context->_Backend::_Receive_multishot(_Op);
+    }
+    auto _Send(::stdnet::_Hidden::_Context_base::_Send_operation* _Op) -> bool
+    {
+        return this->_D_context->_Backend::_Send(_Op);
+    }
+    auto _Sendfile(::stdnet::_Hidden::_Context_base::_Sendfile_operation* _Op) -> bool
+    {
+        return this->_D_context->_Backend::_Sendfile(_Op);
+    }
+    auto _Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation* _Op) -> bool
+    {
+        return this->_D_context->_Backend::_Resume_after(_Op);
+    }
+    auto _Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation* _Op) -> bool
+    {
+        return this->_D_context->_Backend::_Resume_at(_Op);
+    }
+};
+
+// ----------------------------------------------------------------------------
+// A basic_io_context<_Backend> owns a context of the given backend type. It
+// provides the same interface as io_context but sockets and acceptors using
+// it (e.g., basic_socket_acceptor<ip::tcp, epoll_context>) submit their
+// operations directly to the backend. The type-erased io_context remains the
+// choice when the backend is selected at run-time or the context is used
+// from multiple threads.
+
+template <typename _Backend>
+class stdnet::basic_io_context
+{
+private:
+    _Backend _D_context;
+
+public:
+    using backend_type   = _Backend;
+    using scheduler_type = ::stdnet::_Hidden::_Static_scheduler<_Backend>;
+    class executor_type {};
+
+    template <typename... _Args>
+    explicit basic_io_context(_Args&&... _A)
+        : _D_context(::std::forward<_Args>(_A)...)
+    {
+        std::signal(SIGPIPE, SIG_IGN);
+    }
+    basic_io_context(basic_io_context&&) = delete;
+
+    auto _Make_socket(int _D, int _T, int _P, ::std::error_code& _Error) -> ::stdnet::_Hidden::_Socket_id
+    {
+        return this->_D_context._Backend::_Make_socket(_D, _T, _P, _Error);
+    }
+    auto _Release(::stdnet::_Hidden::_Socket_id _Id, ::std::error_code& _Error) -> void
+    {
+        this->_D_context._Backend::_Release(_Id, _Error);
+    }
+    auto _Native_handle(::stdnet::_Hidden::_Socket_id _Id) -> _Stdnet_native_handle_type
+    {
+        return this->_D_context._Backend::_Native_handle(_Id);
+    }
+    auto _Set_option(::stdnet::_Hidden::_Socket_id _Id,
+                     int _Level,
+                     int _Name,
+                     void const* _Data,
+                     ::socklen_t _Size,
+                     ::std::error_code& _Error) -> void
+    {
+        this->_D_context._Backend::_Set_option(_Id, _Level, _Name, _Data, _Size, _Error);
+    }
+    auto _Bind(::stdnet::_Hidden::_Socket_id _Id, ::stdnet::ip::basic_endpoint<::stdnet::ip::tcp> const& _Endpoint, ::std::error_code& _Error)
+    {
+        this->_D_context._Backend::_Bind(_Id, ::stdnet::_Hidden::_Endpoint(_Endpoint), _Error);
+    }
+    auto _Listen(::stdnet::_Hidden::_Socket_id _Id, int _No, ::std::error_code& _Error)
+    {
+        this->_D_context._Backend::_Listen(_Id, _No, _Error);
+    }
+    auto get_scheduler() -> scheduler_type { return scheduler_type(&this->_D_context); }
+    auto set_receive_buffers(::std::size_t _Count, ::std::size_t _Size) -> void
+    {
+        this->_D_context._D_receive_pool._Configure(_Count, _Size);
+    }
+    auto get_buffer_pool() -> ::stdnet::buffer_pool& { return this->_D_context._D_buffer_pool; }
+
+    // Like for io_context, the thread calling run_one() or run() owns the
+    // context.
+    ::std::size_t run_one()
+    {
+        this->_D_context._Set_owner();
+        return this->_D_context._Backend::run_one();
+    }
+    ::std::size_t run()
+    {
+        this->_D_context._Set_owner();
+        return ::stdnet::_Hidden::_Run_all([this](::std::size_t _Max, auto _Deadline){
+            return this->_D_context._Backend::_Run_some(_Max, _Deadline);
+        });
+    }
+    ::std::size_t run_batch(::std::size_t _Max)
+    {
+        this->_D_context._Set_owner();
+        return this->_D_context._Backend::_Run_some(_Max, ::std::chrono::steady_clock::time_point::max());
+    }
+    template <typename _Rep, typename _Period>
+    ::std::size_t run_for(::std::chrono::duration<_Rep, _Period> const& _Duration)
+    {
+        return this->run_until(::std::chrono::steady_clock::now() + _Duration);
+    }
+    template <typename _Clock, typename _Duration>
+    ::std::size_t run_until(::std::chrono::time_point<_Clock, _Duration> const& _Time)
+    {
+        this->_D_context._Set_owner();
+        return ::stdnet::_Hidden::_Run_until([this](::std::size_t _Max, auto _Deadline){
+            return this->_D_context._Backend::_Run_some(_Max, _Deadline);
+        }, _Time);
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -24,23 +24,32 @@
 #include <stdnet/socket_base.hpp>
 #include <stdnet/io_context_scheduler.hpp>
 #include <stdnet/internet.hpp>
+#include <system_error>
+#include <type_traits>
 #include <iostream> //-dk:TODO
 
 // ----------------------------------------------------------------------------
 
-template <typename _Protocol>
+// The scheduler type determines how operations on the socket are submitted:
+// the default _Io_context_scheduler uses the type-erased context of an
+// io_context while the scheduler of a basic_io_context<_Backend> calls the
+// backend directly.
+
+template <typename _Protocol, typename _Scheduler>
 class stdnet::basic_socket
     : public ::stdnet::socket_base
 {
 public:
-    using scheduler_type     = ::stdnet::_Hidden::_Io_context_scheduler;
+    using scheduler_type     = _Scheduler;
     using protocol_type      = _Protocol;
 
 private:
+    enum class _Zero_copy: unsigned char { _Unknown, _Enabled, _Unsupported };
     static constexpr ::stdnet::_Hidden::_Socket_id _S_unused{0xffff'ffff};
     ::stdnet::_Hidden::_Context_base* _D_context;
     protocol_type                     _D_protocol{::stdnet::ip::tcp::v6()}; 
     ::stdnet::_Hidden::_Socket_id     _D_id{_S_unused};
+    _Zero_copy                        _D_zero_copy{_Zero_copy::_Unknown};
 
 public:
     basic_socket()
@@ -56,6 +65,7 @@ public:
         : _D_context(_Other._D_context)
         , _D_protocol(_Other._D_protocol)
         , _D_id(::std::exchange(_Other._D_id, _S_unused))
+        , _D_zero_copy(_Other._D_zero_copy)
     {
     }
     ~basic_socket()
@@ -70,7 +80,50 @@ public:
     {
         return scheduler_type{this->_D_context};
     }
+    template<typename _SettableSocketOption>
+    auto set_option(_SettableSocketOption const& _Option) -> void
+    {
+        ::std::error_code _Error{};
+        this->set_option(_Option, _Error);
+        if (_Error)
+        {
+            throw ::std::system_error(_Error);
+        }
+    }
+    template<typename _SettableSocketOption>
+    auto set_option(_SettableSocketOption const& _Option, ::std::error_code& _Error) -> void
+    {
+        this->_D_context->_Set_option(
+            this->_Id(),
+            _Option.level(this->_D_protocol),
+            _Option.name(this->_D_protocol),
+            _Option.data(this->_D_protocol),
+            _Option.size(this->_D_protocol),
+            _Error);
+        if constexpr (::std::is_same_v<_SettableSocketOption, ::stdnet::socket_base::zero_copy>)
+        {
+            if (!_Error)
+            {
+                this->_D_zero_copy = _Option? _Zero_copy::_Enabled: _Zero_copy::_Unknown;
+            }
+        }
+    }
     auto _Id() const -> ::stdnet::_Hidden::_Socket_id { return this->_D_id; }
+    // _Zero_copy_enabled() enables zero_copy when it is first needed and
+    // remembers whether the socket supports it.
+    auto _Zero_copy_enabled() -> bool
+    {
+        if (this->_D_zero_copy == _Zero_copy::_Unknown)
+        {
+            ::std::error_code _Error{};
+            this->set_option(::stdnet::socket_base::zero_copy(true), _Error);
+            if (_Error)
+            {
+                this->_D_zero_copy = _Zero_copy::_Unsupported;
+            }
+        }
+        return this->_D_zero_copy == _Zero_copy::_Enabled;
+    }
 };
 
 
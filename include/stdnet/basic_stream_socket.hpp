@@ -23,14 +23,15 @@
 #include <stdnet/netfwd.hpp>
 #include <stdnet/io_context.hpp>
 #include <stdnet/basic_socket.hpp>
+#include <concepts>
 #include <functional>
 #include <system_error>
 
 // ----------------------------------------------------------------------------
 
-template <typename _Protocol>
+template <typename _Protocol, typename _Scheduler>
 class stdnet::basic_stream_socket
-    : public basic_socket<_Protocol>
+    : public basic_socket<_Protocol, _Scheduler>
 {
 public:
     using native_handle_type = _Stdnet_native_handle_type;
@@ -44,11 +45,13 @@ public:
     basic_stream_socket(basic_stream_socket&&) = default;
     basic_stream_socket& operator= (basic_stream_socket&&) = default;
     basic_stream_socket(::stdnet::_Hidden::_Context_base* _Context, ::stdnet::_Hidden::_Socket_id _Id)
-        : basic_socket<_Protocol>(_Context, _Id)
+        : basic_socket<_Protocol, _Scheduler>(_Context, _Id)
     {
     }
-    basic_stream_socket(::stdnet::io_context& _Context, endpoint_type const& _Endpoint)
-        : stdnet::basic_socket<_Protocol>(_Context.get_scheduler()._Get_context(),
+    template <typename _Context_t>
+        requires ::std::same_as<typename _Context_t::scheduler_type, _Scheduler>
+    basic_stream_socket(_Context_t& _Context, endpoint_type const& _Endpoint)
+        : stdnet::basic_socket<_Protocol, _Scheduler>(_Context.get_scheduler()._Get_context(),
             ::std::invoke([_P = _Endpoint.protocol(), &_Context]{
                 ::std::error_code _Error{};
                 auto _Rc(_Context._Make_socket(_P.family(), _P.type(), _P.protocol(), _Error));
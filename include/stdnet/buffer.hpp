@@ -29,6 +29,7 @@
 #include <sys/socket.h>
 #include <string>
 #include <system_error>
+#include <type_traits>
 #include <cassert>
 #include <cstddef>
 
@@ -50,7 +51,7 @@ namespace stdnet
     template <typename> struct is_const_buffer_sequence;
     template <typename> struct is_dynamic_buffer;
 
-    struct buffer_sequence;
+    template <typename, ::std::size_t> class buffer_sequence;
 
     template <::std::size_t _S>
     auto buffer(char (&)[_S]) -> ::stdnet::mutable_buffer;
@@ -83,15 +84,30 @@ inline auto stdnet::stream_category() noexcept -> ::std::error_category const&
         {
             return "stream_error";
         }
-        auto message(int) const noexcept -> ::std::string override
+        auto message(int _Value) const noexcept -> ::std::string override
         {
-            return {};
+            switch (::stdnet::stream_errc(_Value))
+            {
+            case ::stdnet::stream_errc::eof: return "end of file";
+            case ::stdnet::stream_errc::not_found: return "delimiter not found";
+            }
+            return "unknown stream error";
         }
     };
     static _Category _Rc{};
     return _Rc; 
 }
 
+inline auto stdnet::make_error_code(::stdnet::stream_errc _Value) noexcept -> ::std::error_code
+{
+    return ::std::error_code(int(_Value), ::stdnet::stream_category());
+}
+
+inline auto stdnet::make_error_condition(::stdnet::stream_errc _Value) noexcept -> ::std::error_condition
+{
+    return ::std::error_condition(int(_Value), ::stdnet::stream_category());
+}
+
 // ----------------------------------------------------------------------------
 
 struct stdnet::mutable_buffer
@@ -128,6 +144,101 @@ inline auto stdnet::buffer(char const* _B, ::std::size_t _Size) -> ::stdnet::con
     return ::stdnet::const_buffer(_B, _Size);
 }
 
+// ----------------------------------------------------------------------------
+// A buffer_sequence gathers a fixed number of buffers into one operation,
+// e.g., a header and a body go out using one sendmsg(). After a partial
+// transfer consume() drops the transferred bytes so the sequence can be
+// used again for the remainder. The sequence is mutable only if all
+// buffers are mutable:
+//
+//     stdnet::buffer_sequence buffers(stdnet::buffer(head), stdnet::buffer(body));
+//     while (!buffers.empty())
+//         buffers.consume(co_await stdnet::async_send(stream, buffers));
+
+template <typename _Buffer, ::std::size_t _N>
+class stdnet::buffer_sequence
+{
+private:
+    ::iovec       _D_vec[_N];
+    ::std::size_t _D_first{};
+
+public:
+    template <typename... _Buffers>
+        requires (sizeof...(_Buffers) == _N)
+    buffer_sequence(_Buffers... _B)
+        : _D_vec{ *_B.data()... }
+    {
+        this->consume(0u);
+    }
+
+    auto data() -> ::iovec*      { return this->_D_vec + this->_D_first; }
+    auto size() -> ::std::size_t { return _N - this->_D_first; }
+    auto empty() const -> bool   { return this->_D_first == _N; }
+    auto consume(::std::size_t _Size) -> void
+    {
+        for (; this->_D_first != _N && this->_D_vec[this->_D_first].iov_len <= _Size; ++this->_D_first)
+        {
+            _Size -= this->_D_vec[this->_D_first].iov_len;
+        }
+        if (this->_D_first != _N)
+        {
+            ::iovec& _Vec(this->_D_vec[this->_D_first]);
+            _Vec.iov_base = static_cast<char*>(_Vec.iov_base) + _Size;
+            _Vec.iov_len -= _Size;
+        }
+    }
+};
+
+namespace stdnet
+{
+    template <typename... _Buffers>
+    buffer_sequence(_Buffers...)
+        -> buffer_sequence<::std::conditional_t<(::std::is_same_v<_Buffers, ::stdnet::mutable_buffer> && ...),
+                                                ::stdnet::mutable_buffer,
+                                                ::stdnet::const_buffer>,
+                           sizeof...(_Buffers)>;
+}
+
+// ----------------------------------------------------------------------------
+
+template <typename>
+struct stdnet::is_mutable_buffer_sequence
+    : ::std::false_type
+{
+};
+template <>
+struct stdnet::is_mutable_buffer_sequence<::stdnet::mutable_buffer>
+    : ::std::true_type
+{
+};
+template <::std::size_t _N>
+struct stdnet::is_mutable_buffer_sequence<::stdnet::buffer_sequence<::stdnet::mutable_buffer, _N>>
+    : ::std::true_type
+{
+};
+
+template <typename _T>
+struct stdnet::is_const_buffer_sequence
+    : ::stdnet::is_mutable_buffer_sequence<_T>
+{
+};
+template <>
+struct stdnet::is_const_buffer_sequence<::stdnet::const_buffer>
+    : ::std::true_type
+{
+};
+template <::std::size_t _N>
+struct stdnet::is_const_buffer_sequence<::stdnet::buffer_sequence<::stdnet::const_buffer, _N>>
+    : ::std::true_type
+{
+};
+
+template <typename>
+struct stdnet::is_dynamic_buffer
+    : ::std::false_type
+{
+};
+
 // ----------------------------------------------------------------------------
 
 #endif
@@ -0,0 +1,363 @@
+// stdnet/buffer_pool.hpp                                             -*-C++-*-
+// ----------------------------------------------------------------------------
+/*
+ * Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_STDNET_BUFFER_POOL
+#define INCLUDED_STDNET_BUFFER_POOL
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+
+// ----------------------------------------------------------------------------
+
+namespace stdnet
+{
+    class buffer_pool;
+    class pooled_buffer;
+}
+
+// ----------------------------------------------------------------------------
+// A pooled_buffer owns a buffer leased from a buffer_pool until it is
+// destroyed or reset(). It is a contiguous range, i.e., stdnet::buffer()
+// turns it into a mutable_buffer usable with async_receive() and
+// async_send(). The buffer needs to be released before the pool is
+// destroyed but it may be released on any thread.
+
+class stdnet::pooled_buffer
+{
+private:
+    ::stdnet::buffer_pool* _D_pool{};
+    char*                  _D_data{};
+
+public:
+    pooled_buffer() = default;
+    pooled_buffer(::stdnet::buffer_pool* _Pool, char* _Data)
+        : _D_pool(_Pool)
+        , _D_data(_Data)
+    {
+    }
+    pooled_buffer(pooled_buffer&& _Other)
+        : _D_pool(::std::exchange(_Other._D_pool, nullptr))
+        , _D_data(::std::exchange(_Other._D_data, nullptr))
+    {
+    }
+    auto operator=(pooled_buffer&& _Other) -> pooled_buffer&
+    {
+        if (this != &_Other)
+        {
+            this->reset();
+            this->_D_pool = ::std::exchange(_Other._D_pool, nullptr);
+            this->_D_data = ::std::exchange(_Other._D_data, nullptr);
+        }
+        return *this;
+    }
+    ~pooled_buffer() { this->reset(); }
+
+    explicit operator bool() const { return this->_D_data != nullptr; }
+    auto data() const -> char* { return this->_D_data; }
+    auto size() const -> ::std::size_t;
+    auto reset() -> void;
+};
+
+// ----------------------------------------------------------------------------
+// A buffer_pool hands out buffers of one size. The buffers are carved from
+// 2 MiB chunks which are backed by huge pages where possible (MAP_HUGETLB
+// if huge pages are reserved, transparent huge pages otherwise). Chunks are
+// only allocated when buffers are leased and they are kept until the pool
+// is destroyed.
+//
+// Each thread leases from and releases to its own cache of the pool without
+// synchronisation. The caches exchange batches of buffers with a shared free
+// list protected by a mutex. A thread's cache is created when it first uses
+// the pool. Threads are numbered when they first use any pool; when a thread
+// exits, its caches are flushed to the shared lists of the pools and its
+// number is reused for the next thread. Threads beyond the number of caches
+// only use the shared list.
+
+class stdnet::buffer_pool
+{
+public:
+    static constexpr ::std::size_t default_buffer_size{16384u};
+    static constexpr ::std::size_t default_thread_caches{64u};
+
+private:
+    static constexpr ::std::size_t _Cache_size{64u};
+    static constexpr ::std::size_t _Batch{_Cache_size / 2u};
+    static constexpr ::std::size_t _Chunk_size{::std::size_t(2u) << 20};
+
+    struct alignas(64) _Cache
+    {
+        ::std::size_t _Count{};
+        char*         _Buffers[_Cache_size];
+    };
+    struct _Chunk
+    {
+        void*         _Address;
+        ::std::size_t _Size;
+    };
+    // _Threads holds the numbers of exited threads for reuse and the pools
+    // whose caches are flushed when a thread exits. A _Thread_slot holds the
+    // number of a thread and returns it when the thread exits.
+    struct _Threads
+    {
+        ::std::mutex                          _Mutex;
+        ::std::size_t                         _Next{};
+        ::std::vector<::std::size_t>          _Free;
+        ::std::vector<::stdnet::buffer_pool*> _Pools;
+    };
+    struct _Thread_slot
+    {
+        ::std::size_t _Index;
+        _Thread_slot();
+        _Thread_slot(_Thread_slot&&) = delete;
+        ~_Thread_slot();
+    };
+
+    ::std::size_t                                 _D_size;
+    ::std::size_t                                 _D_thread_caches;
+    ::std::unique_ptr<::std::unique_ptr<_Cache>[]> _D_caches;
+    ::std::mutex                                  _D_mutex;
+    ::std::vector<char*>                          _D_free;
+    ::std::vector<_Chunk>                         _D_chunks;
+
+    static auto _Registry() -> _Threads&;
+    static auto _Thread_index() -> ::std::size_t;
+    auto _Thread_cache() -> _Cache*;
+    auto _Flush(::std::size_t) -> void;
+    auto _Allocate_chunk() -> void;
+    auto _Take_shared() -> char*;
+
+public:
+    explicit buffer_pool(::std::size_t _Size = default_buffer_size,
+                         ::std::size_t _Thread_caches = default_thread_caches);
+    buffer_pool(buffer_pool&&) = delete;
+    ~buffer_pool();
+
+    auto buffer_size() const -> ::std::size_t { return this->_D_size; }
+    auto lease() -> ::stdnet::pooled_buffer;
+    auto _Return(char*) -> void;
+};
+
+// ----------------------------------------------------------------------------
+
+inline auto stdnet::pooled_buffer::size() const -> ::std::size_t
+{
+    return this->_D_pool? this->_D_pool->buffer_size(): 0u;
+}
+
+inline auto stdnet::pooled_buffer::reset() -> void
+{
+    if (this->_D_pool)
+    {
+        ::std::exchange(this->_D_pool, nullptr)->_Return(::std::exchange(this->_D_data, nullptr));
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline stdnet::buffer_pool::buffer_pool(::std::size_t _Size, ::std::size_t _Thread_caches)
+    : _D_size((_Size + 63u) & ~::std::size_t(63u))
+    , _D_thread_caches(_Thread_caches)
+    , _D_caches(::std::make_unique<::std::unique_ptr<_Cache>[]>(_Thread_caches))
+{
+    _Threads& _Registry(::stdnet::buffer_pool::_Registry());
+    ::std::lock_guard _Lock(_Registry._Mutex);
+    _Registry._Pools.push_back(this);
+}
+
+inline stdnet::buffer_pool::~buffer_pool()
+{
+    {
+        _Threads& _Registry(::stdnet::buffer_pool::_Registry());
+        ::std::lock_guard _Lock(_Registry._Mutex);
+        _Registry._Pools.erase(::std::find(_Registry._Pools.begin(), _Registry._Pools.end(), this));
+    }
+    for (_Chunk const& _C: this->_D_chunks)
+    {
+        ::munmap(_C._Address, _C._Size);
+    }
+}
+
+inline auto stdnet::buffer_pool::_Registry() -> _Threads&
+{
+    static _Threads _Rc;
+    return _Rc;
+}
+
+// A thread reusing the number of an exited thread also reuses the entries
+// for its caches: the registry's mutex orders the accesses of both threads.
+
+inline stdnet::buffer_pool::_Thread_slot::_Thread_slot()
+{
+    _Threads& _Registry(::stdnet::buffer_pool::_Registry());
+    ::std::lock_guard _Lock(_Registry._Mutex);
+    if (_Registry._Free.empty())
+    {
+        this->_Index = _Registry._Next++;
+    }
+    else
+    {
+        this->_Index = _Registry._Free.back();
+        _Registry._Free.pop_back();
+    }
+}
+
+inline stdnet::buffer_pool::_Thread_slot::~_Thread_slot()
+{
+    _Threads& _Registry(::stdnet::buffer_pool::_Registry());
+    ::std::lock_guard _Lock(_Registry._Mutex);
+    for (::stdnet::buffer_pool* _Pool: _Registry._Pools)
+    {
+        _Pool->_Flush(this->_Index);
+    }
+    _Registry._Free.push_back(this->_Index);
+}
+
+inline auto stdnet::buffer_pool::_Thread_index() -> ::std::size_t
+{
+    thread_local _Thread_slot const _Slot;
+    return _Slot._Index;
+}
+
+inline auto stdnet::buffer_pool::_Thread_cache() -> _Cache*
+{
+    ::std::size_t _Index(_Thread_index());
+    if (this->_D_thread_caches <= _Index)
+    {
+        return nullptr;
+    }
+    ::std::unique_ptr<_Cache>& _C(this->_D_caches[_Index]);
+    if (!_C)
+    {
+        _C = ::std::make_unique<_Cache>();
+    }
+    return _C.get();
+}
+
+// _Flush() is called with the registry's mutex held when the thread with
+// the given number exits: the buffers in its cache go to the shared list.
+
+inline auto stdnet::buffer_pool::_Flush(::std::size_t _Index) -> void
+{
+    if (_Index < this->_D_thread_caches && this->_D_caches[_Index])
+    {
+        ::std::unique_ptr<_Cache> _C(::std::move(this->_D_caches[_Index]));
+        ::std::lock_guard _Lock(this->_D_mutex);
+        this->_D_free.insert(this->_D_free.end(), _C->_Buffers, _C->_Buffers + _C->_Count);
+    }
+}
+
+// _Allocate_chunk() is called with the mutex held. Transparent huge pages
+// need a suitably aligned range: a larger range is mapped and trimmed.
+
+inline auto stdnet::buffer_pool::_Allocate_chunk() -> void
+{
+    ::std::size_t _Size((::std::max(this->_D_size, _Chunk_size) + _Chunk_size - 1u) & ~(_Chunk_size - 1u));
+    void* _Address(::mmap(nullptr, _Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0));
+    if (_Address == MAP_FAILED)
+    {
+        void* _Range(::mmap(nullptr, _Size + _Chunk_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (_Range == MAP_FAILED)
+        {
+            throw ::std::bad_alloc();
+        }
+        ::std::uintptr_t _Begin(reinterpret_cast<::std::uintptr_t>(_Range));
+        ::std::uintptr_t _Aligned((_Begin + _Chunk_size - 1u) & ~::std::uintptr_t(_Chunk_size - 1u));
+        if (_Begin != _Aligned)
+        {
+            ::munmap(_Range, _Aligned - _Begin);
+        }
+        if (::std::size_t _Tail = _Chunk_size - (_Aligned - _Begin))
+        {
+            ::munmap(reinterpret_cast<void*>(_Aligned + _Size), _Tail);
+        }
+        _Address = reinterpret_cast<void*>(_Aligned);
+        ::madvise(_Address, _Size, MADV_HUGEPAGE);
+    }
+    this->_D_chunks.push_back(_Chunk{_Address, _Size});
+
+    char* _Begin(static_cast<char*>(_Address));
+    for (::std::size_t _Offset(_Size - _Size % this->_D_size); _Offset != 0u; )
+    {
+        _Offset -= this->_D_size;
+        this->_D_free.push_back(_Begin + _Offset);
+    }
+}
+
+inline auto stdnet::buffer_pool::_Take_shared() -> char*
+{
+    ::std::lock_guard _Lock(this->_D_mutex);
+    if (this->_D_free.empty())
+    {
+        this->_Allocate_chunk();
+    }
+    char* _Rc(this->_D_free.back());
+    this->_D_free.pop_back();
+    return _Rc;
+}
+
+inline auto stdnet::buffer_pool::lease() -> ::stdnet::pooled_buffer
+{
+    _Cache* _C(this->_Thread_cache());
+    if (!_C)
+    {
+        return ::stdnet::pooled_buffer(this, this->_Take_shared());
+    }
+    if (_C->_Count == 0u)
+    {
+        ::std::lock_guard _Lock(this->_D_mutex);
+        if (this->_D_free.size() < _Batch)
+        {
+            this->_Allocate_chunk();
+        }
+        ::std::size_t _Count(::std::min(_Batch, this->_D_free.size()));
+        ::std::copy(this->_D_free.end() - _Count, this->_D_free.end(), _C->_Buffers);
+        this->_D_free.resize(this->_D_free.size() - _Count);
+        _C->_Count = _Count;
+    }
+    return ::stdnet::pooled_buffer(this, _C->_Buffers[--_C->_Count]);
+}
+
+inline auto stdnet::buffer_pool::_Return(char* _Buffer) -> void
+{
+    _Cache* _C(this->_Thread_cache());
+    if (!_C)
+    {
+        ::std::lock_guard _Lock(this->_D_mutex);
+        this->_D_free.push_back(_Buffer);
+        return;
+    }
+    if (_C->_Count == _Cache_size)
+    {
+        ::std::lock_guard _Lock(this->_D_mutex);
+        this->_D_free.insert(this->_D_free.end(), _C->_Buffers + _Cache_size - _Batch, _C->_Buffers + _Cache_size);
+        _C->_Count -= _Batch;
+    }
+    _C->_Buffers[_C->_Count++] = _Buffer;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -22,7 +22,11 @@
 
 #include <stdnet/netfwd.hpp>
 #include <cstddef>
-#include <variant>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 // ----------------------------------------------------------------------------
@@ -34,48 +38,131 @@ namespace stdnet::_Hidden
 }
 
 // ----------------------------------------------------------------------------
+// _Container is a slot map holding the records of the sockets of a context.
+// A _Socket_id combines the index of a slot (the low _Index_bits) with the
+// generation of the slot (the remaining high bits). The generation changes
+// whenever the slot is released, i.e., a stale id can be detected using
+// _Valid() rather than silently referring to a newer socket reusing the slot.
+// The largest index is never used, i.e., no id is equal to _Invalid.
+//
+// The native handle and the current id of all slots are stored in a dense
+// array which is accessed by virtually all operations. The remaining parts
+// of the records live in fixed size chunks which are never moved: growing
+// the container doesn't relocate records referenced by pending operations
+// or registered with the kernel or an event library. Records are constructed
+// in place when a socket is inserted and destroyed when it is erased.
 
 template <typename _Record>
 class stdnet::_Hidden::_Container
 {
 private:
-    ::std::vector<::std::variant<::std::size_t, _Record>> _Records;
-    ::std::size_t                                         _Free{};
+    static constexpr unsigned              _Index_bits{22u};
+    static constexpr ::std::uint_least32_t _Index_mask{(::std::uint_least32_t(1u) << _Index_bits) - 1u};
+    static constexpr ::std::uint_least32_t _Generation_step{_Index_mask + 1u};
+    static constexpr unsigned              _Chunk_bits{8u};
+    static constexpr ::std::size_t         _Chunk_size{::std::size_t(1u) << _Chunk_bits};
+
+    // For a used slot _Id is the id of the socket. For a free slot _Handle is
+    // _Stdnet_invalid_handle and _Id combines the generation the slot will
+    // use next with the index of the next free slot.
+    struct _Slot
+    {
+        ::stdnet::_Stdnet_native_handle_type _Handle;
+        ::std::uint_least32_t                _Id;
+    };
+    struct _Chunk
+    {
+        alignas(_Record) unsigned char _Data[_Chunk_size][sizeof(_Record)];
+    };
+
+    ::std::vector<_Slot>                     _D_slots;
+    ::std::vector<::std::unique_ptr<_Chunk>> _D_chunks;
+    ::std::uint_least32_t                    _D_free{_Index_mask};
+    ::std::size_t                            _D_size{};
+
+    static auto _Index(::stdnet::_Hidden::_Socket_id _Id) -> ::std::size_t { return _Id & _Index_mask; }
+    auto _Get(::std::size_t _I) -> _Record*
+    {
+        return ::std::launder(reinterpret_cast<_Record*>(this->_D_chunks[_I >> _Chunk_bits]->_Data[_I & (_Chunk_size - 1u)]));
+    }
 
 public:
-    auto _Insert(_Record _R) -> ::stdnet::_Hidden::_Socket_id;
+    _Container() = default;
+    _Container(_Container&&) = delete;
+    ~_Container();
+
+    template <typename... _Args>
+    auto _Insert(::stdnet::_Stdnet_native_handle_type _Handle, _Args&&... _A) -> ::stdnet::_Hidden::_Socket_id;
     auto _Erase(::stdnet::_Hidden::_Socket_id _Id) -> void;
-    auto operator[](::stdnet::_Hidden::_Socket_id _Id) -> _Record&;
+    auto _Valid(::stdnet::_Hidden::_Socket_id _Id) const -> bool;
+    auto _Size() const -> ::std::size_t { return this->_D_size; }
+    auto _Handle(::stdnet::_Hidden::_Socket_id _Id) const -> ::stdnet::_Stdnet_native_handle_type
+    {
+        return this->_D_slots[_Index(_Id)]._Handle;
+    }
+    auto operator[](::stdnet::_Hidden::_Socket_id _Id) -> _Record& { return *this->_Get(_Index(_Id)); }
 };
 
 // ----------------------------------------------------------------------------
 
 template <typename _Record>
-inline auto stdnet::_Hidden::_Container<_Record>::_Insert(_Record _R) -> ::stdnet::_Hidden::_Socket_id
+inline stdnet::_Hidden::_Container<_Record>::~_Container()
 {
-    if (this->_Free == this->_Records.size())
+    for (::std::size_t _I{}; _I != this->_D_slots.size(); ++_I)
     {
-        this->_Records.emplace_back(::std::move(_R));
-        return ::stdnet::_Hidden::_Socket_id(this->_Free++);
+        if (this->_D_slots[_I]._Handle != ::stdnet::_Stdnet_invalid_handle)
+        {
+            this->_Get(_I)->~_Record();
+        }
     }
-    else
+}
+
+template <typename _Record>
+    template <typename... _Args>
+inline auto stdnet::_Hidden::_Container<_Record>::_Insert(::stdnet::_Stdnet_native_handle_type _Handle, _Args&&... _A)
+    -> ::stdnet::_Hidden::_Socket_id
+{
+    ::std::uint_least32_t _I(this->_D_free);
+    if (_I == _Index_mask)
     {
-        ::std::size_t _Rc(std::exchange(this->_Free, ::std::get<0>(this->_Records[this->_Free])));
-        this->_Records[_Rc] = ::std::move(_R);
-        return ::stdnet::_Hidden::_Socket_id(_Rc);
+        _I = ::std::uint_least32_t(this->_D_slots.size());
+        if (_I == _Index_mask)
+        {
+            throw ::std::length_error("too many sockets in one context");
+        }
+        if (this->_D_chunks.size() << _Chunk_bits == _I)
+        {
+            this->_D_chunks.push_back(::std::make_unique<_Chunk>());
+        }
+        this->_D_slots.push_back(_Slot{::stdnet::_Stdnet_invalid_handle, _Index_mask});
     }
+    _Slot& _S(this->_D_slots[_I]);
+    ::new (this->_D_chunks[_I >> _Chunk_bits]->_Data[_I & (_Chunk_size - 1u)]) _Record(::std::forward<_Args>(_A)...);
+    this->_D_free = _S._Id & _Index_mask;
+    _S._Handle = _Handle;
+    _S._Id = (_S._Id & ~_Index_mask) | _I;
+    ++this->_D_size;
+    return ::stdnet::_Hidden::_Socket_id(_S._Id);
 }
 
 template <typename _Record>
 inline auto stdnet::_Hidden::_Container<_Record>::_Erase(::stdnet::_Hidden::_Socket_id _Id) -> void
 {
-    this->_Records[::std::size_t(_Id)] = std::exchange(this->_Free, ::std::size_t(_Id));
+    ::std::size_t _I(_Index(_Id));
+    _Slot&        _S(this->_D_slots[_I]);
+    this->_Get(_I)->~_Record();
+    _S._Handle = ::stdnet::_Stdnet_invalid_handle;
+    _S._Id = ((_S._Id & ~_Index_mask) + _Generation_step) | ::std::exchange(this->_D_free, ::std::uint_least32_t(_I));
+    --this->_D_size;
 }
 
 template <typename _Record>
-inline auto stdnet::_Hidden::_Container<_Record>::operator[](::stdnet::_Hidden::_Socket_id _Id) -> _Record&
+inline auto stdnet::_Hidden::_Container<_Record>::_Valid(::stdnet::_Hidden::_Socket_id _Id) const -> bool
 {
-    return ::std::get<1>(this->_Records[::std::size_t(_Id)]);
+    ::std::size_t _I(_Index(_Id));
+    return _I < this->_D_slots.size()
+        && this->_D_slots[_I]._Id == _Id
+        && this->_D_slots[_I]._Handle != ::stdnet::_Stdnet_invalid_handle;
 }
 
 // ----------------------------------------------------------------------------
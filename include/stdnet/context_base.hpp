@@ -22,23 +22,36 @@
 
 #include <stdnet/io_base.hpp>
 #include <stdnet/endpoint.hpp>
+#include <stdnet/receive_pool.hpp>
+#include <stdnet/buffer_pool.hpp>
 #include <chrono>
+#include <cstddef>
+#include <atomic>
 #include <optional>
 #include <system_error>
+#include <thread>
 #include <sys/socket.h>
-#include <sys/time.h>
+#include <sys/types.h>
 
 // ----------------------------------------------------------------------------
 
 namespace stdnet::_Hidden
 {
     struct _Context_base;
+    struct _Io_deadline;
 }
 
 // ----------------------------------------------------------------------------
 
 struct stdnet::_Hidden::_Context_base
 {
+    // Timer operations provide storage for backend specific state (e.g., a
+    // libevent event) allowing timers to be set up without allocations.
+    struct _Timer_storage
+    {
+        alignas(::std::max_align_t) unsigned char _Data[128];
+    };
+
     using _Accept_operation = ::stdnet::_Hidden::_Io_operation<
         ::std::tuple<::stdnet::_Hidden::_Endpoint,
                      ::socklen_t,
@@ -48,21 +61,118 @@ struct stdnet::_Hidden::_Context_base
     using _Connect_operation = ::stdnet::_Hidden::_Io_operation<
         ::std::tuple<::stdnet::_Hidden::_Endpoint>
         >;
+    // The message, the flags, the number of bytes transferred, and the number
+    // of bytes needed before the operation completes: the buffers are
+    // transferred using one operation until that many bytes got transferred
+    // or the stream ended (0 means that any transfer completes it).
     using _Receive_operation = ::stdnet::_Hidden::_Io_operation<
-        ::std::tuple<::msghdr, int, ::std::size_t>
+        ::std::tuple<::msghdr, int, ::std::size_t, ::std::size_t>
         >;
     using _Send_operation = ::stdnet::_Hidden::_Io_operation<
-        ::std::tuple<::msghdr, int, ::std::size_t>
+        ::std::tuple<::msghdr, int, ::std::size_t, ::std::size_t>
+        >;
+    // The file, the offset into the file, the number of bytes to send, and
+    // the number of bytes sent so far: the offset advances as bytes are sent.
+    using _Sendfile_operation = ::stdnet::_Hidden::_Io_operation<
+        ::std::tuple<int, ::off_t, ::std::size_t, ::std::size_t>
+        >;
+    // The flags, the index of the filled buffer, and the number of bytes.
+    using _Receive_multishot_operation = ::stdnet::_Hidden::_Io_operation<
+        ::std::tuple<int, ::stdnet::_Hidden::_Receive_pool::_Index, ::std::size_t>
         >;
     using _Resume_after_operation = ::stdnet::_Hidden::_Io_operation<
-        ::std::tuple<::std::chrono::microseconds, ::timeval>
+        ::std::tuple<::std::chrono::nanoseconds, _Timer_storage>
         >;
     using _Resume_at_operation = ::stdnet::_Hidden::_Io_operation<
-        ::std::tuple<::std::chrono::system_clock::time_point, ::timeval>
+        ::std::tuple<::std::chrono::steady_clock::time_point, _Timer_storage>
         >;
 
+    // Operations are started directly when the submitting thread owns the
+    // context, i.e., when it is the thread running it. Operations started
+    // from other threads are posted: _Post() stores the function doing the
+    // actual submission as _Work, queues the operation, and wakes up the
+    // context which calls _Run_posted() from run_one(). _Run_posted() returns
+    // the number of operations which completed directly. Only one thread at
+    // a time may run a context.
+    ::std::atomic<::std::thread::id>  _D_owner{::std::this_thread::get_id()};
+    ::stdnet::_Hidden::_Io_mpsc_queue _D_posted;
+    // Cancellation requests from other threads are pushed onto a separate
+    // lock-free stack and processed in no particular order but after the
+    // submissions posted before them: _Run_posted() takes the cancellations
+    // first and processes them after the submissions it takes afterwards,
+    // i.e., a stop requested after starting an operation finds it.
+    ::std::atomic<::stdnet::_Hidden::_Cancel_node*> _D_cancels{nullptr};
+
+    auto _Set_owner() -> void { this->_D_owner.store(::std::this_thread::get_id(), ::std::memory_order_relaxed); }
+    auto _Owned() const -> bool { return this->_D_owner.load(::std::memory_order_relaxed) == ::std::this_thread::get_id(); }
+    auto _Post(::stdnet::_Hidden::_Io_base* _Op, decltype(_Io_base::_Work) _Submit) -> void
+    {
+        _Op->_Work = _Submit;
+        if (this->_D_posted._Push(_Op))
+        {
+            this->_Wakeup();
+        }
+    }
+    auto _Post_cancel(::stdnet::_Hidden::_Cancel_node* _Node) -> void
+    {
+        ::stdnet::_Hidden::_Cancel_node* _Old(this->_D_cancels.load(::std::memory_order_relaxed));
+        do
+        {
+            _Node->_Next = _Old;
+        }
+        while (!this->_D_cancels.compare_exchange_weak(_Old, _Node, ::std::memory_order_release, ::std::memory_order_relaxed));
+        if (_Old == nullptr)
+        {
+            this->_Wakeup();
+        }
+    }
+    auto _Run_posted() -> ::std::size_t
+    {
+        ::stdnet::_Hidden::_Cancel_node* _Node(this->_D_cancels.load(::std::memory_order_relaxed)
+                                               ? this->_D_cancels.exchange(nullptr, ::std::memory_order_acquire)
+                                               : nullptr);
+        ::std::size_t _Count{};
+        if (!this->_D_posted._Empty())
+        {
+            ::stdnet::_Hidden::_Io_queue _Queue(this->_D_posted._Take());
+            while (::stdnet::_Hidden::_Io_base* _Op = _Queue._Pop())
+            {
+                if (!_Op->_Work(*this, _Op))
+                {
+                    ++_Count;
+                    _Op->_Complete();
+                }
+            }
+        }
+        while (_Node)
+        {
+            this->_Cancel(::std::exchange(_Node, _Node->_Next));
+        }
+        return _Count;
+    }
+
+    // The buffers for multishot receives are shared by all sockets of the
+    // context.
+    ::stdnet::_Hidden::_Receive_pool _D_receive_pool;
+    // The buffers leased by users of the context, e.g., for requests.
+    ::stdnet::buffer_pool            _D_buffer_pool;
+
+    // Contexts cache the current time once per loop iteration: deadlines of
+    // timers started while completions are processed are relative to the
+    // cached time rather than each calling steady_clock::now().
+    ::std::chrono::steady_clock::time_point _D_now{::std::chrono::steady_clock::now()};
+
+    auto _Now() const -> ::std::chrono::steady_clock::time_point { return this->_D_now; }
+    auto _Update_now() -> ::std::chrono::steady_clock::time_point
+    {
+        return this->_D_now = ::std::chrono::steady_clock::now();
+    }
+
     virtual ~_Context_base() = default;
-    virtual auto _Make_socket(int) -> ::stdnet::_Hidden::_Socket_id = 0;
+    virtual auto _Wakeup() -> void = 0;
+    // _Make_socket(_Fd, _Blocking) takes ownership of an existing descriptor
+    // which is in blocking mode if _Blocking is true.
+    virtual auto _Make_socket(int, bool) -> ::stdnet::_Hidden::_Socket_id = 0;
     virtual auto _Make_socket(int, int, int, ::std::error_code&) -> ::stdnet::_Hidden::_Socket_id = 0;
     virtual auto _Release(::stdnet::_Hidden::_Socket_id, ::std::error_code&) -> void = 0;
     virtual auto _Native_handle(::stdnet::_Hidden::_Socket_id) -> _Stdnet_native_handle_type = 0;
@@ -71,16 +181,66 @@ struct stdnet::_Hidden::_Context_base
     virtual auto _Listen(::stdnet::_Hidden::_Socket_id, int, ::std::error_code&) -> void = 0;
 
     virtual auto run_one() -> ::std::size_t = 0;
+    // _Run_some() processes up to _Max completions. If nothing is ready, it
+    // waits for readiness (but not beyond _Deadline) and processes the
+    // completions which became ready with one wait. It returns the number of
+    // completions processed which is only zero if the deadline was reached
+    // or there is no outstanding work.
+    virtual auto _Run_some(::std::size_t _Max, ::std::chrono::steady_clock::time_point _Deadline) -> ::std::size_t = 0;
 
-    virtual auto _Cancel(::stdnet::_Hidden::_Io_base*, ::stdnet::_Hidden::_Io_base*) -> void = 0;
+    virtual auto _Cancel(::stdnet::_Hidden::_Cancel_node*) -> void = 0;
     virtual auto _Accept(::stdnet::_Hidden::_Context_base::_Accept_operation*) -> bool = 0;
+    // _Accept_multishot() keeps the operation armed: _Complete() is called
+    // for each accepted connection until the operation ends with _Error() or
+    // _Cancel(), e.g., when the listener is released. It always returns true.
+    // If the backend can't do it, the operation fails with
+    // operation_not_supported.
+    virtual auto _Accept_multishot(::stdnet::_Hidden::_Context_base::_Accept_operation*) -> bool = 0;
     virtual auto _Connect(::stdnet::_Hidden::_Context_base::_Connect_operation*) -> bool = 0;
     virtual auto _Receive(::stdnet::_Hidden::_Context_base::_Receive_operation*) -> bool = 0;
+    // _Receive_multishot() keeps receiving into buffers of _D_receive_pool:
+    // _Complete() is called for each filled buffer whose ownership passes to
+    // the operation. The operation ends with _Cancel() when the peer shut
+    // down the connection or the socket is released and with _Error() (e.g.,
+    // ENOBUFS if the pool is exhausted or operation_not_supported if the
+    // backend can't do it). It always returns true.
+    virtual auto _Receive_multishot(::stdnet::_Hidden::_Context_base::_Receive_multishot_operation*) -> bool = 0;
     virtual auto _Send(::stdnet::_Hidden::_Context_base::_Send_operation*) -> bool = 0;
+    // _Sendfile() sends a range of a file using sendfile(): the socket is
+    // made non-blocking and the operation waits for writability whenever the
+    // socket buffer is full. It completes once all bytes were sent or the
+    // file ended.
+    virtual auto _Sendfile(::stdnet::_Hidden::_Context_base::_Sendfile_operation*) -> bool = 0;
     virtual auto _Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation*) -> bool = 0;
     virtual auto _Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation*) -> bool = 0;
 };
 
+// ----------------------------------------------------------------------------
+// An _Io_deadline can be attached to socket operations which need to complete
+// by a given time. When such an operation needs to wait, the context arms a
+// timer using the _Storage alongside the operation. If the timer expires
+// first, the operation completes with errc::timed_out. A relative timeout is
+// turned into a deadline using the context's cached time when the deadline
+// is armed the first time, i.e., without reading the clock per operation.
+
+struct stdnet::_Hidden::_Io_deadline
+{
+    ::std::chrono::steady_clock::time_point          _Time;
+    ::std::chrono::steady_clock::duration            _Timeout{};
+    bool                                             _Relative{false};
+    ::stdnet::_Hidden::_Context_base::_Timer_storage _Storage;
+
+    auto _Resolve(::std::chrono::steady_clock::time_point _Now) -> ::std::chrono::steady_clock::time_point
+    {
+        if (this->_Relative)
+        {
+            this->_Time     = _Now + this->_Timeout;
+            this->_Relative = false;
+        }
+        return this->_Time;
+    }
+};
+
 // ----------------------------------------------------------------------------
 
 #endif
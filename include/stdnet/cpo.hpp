@@ -23,6 +23,8 @@
 #include <stdnet/io_base.hpp>
 #include <stdexec/concepts.hpp>
 #include <stdexec/execution.hpp>
+#include <atomic>
+#include <cassert>
 #include <type_traits>
 #include <utility>
 
@@ -33,13 +35,65 @@ namespace stdnet::_Hidden
     template <typename> struct _Cpo;
 }
 
+// ----------------------------------------------------------------------------
+// The number of outstanding completions of an operation state is only
+// accessed concurrently when a stop request arrives on another thread while
+// the context completes the operation. That can't happen if the receiver's
+// stop token is unstoppable or if the scheduler's context is only ever used
+// from one thread (the scheduler declares a constexpr _Single_threaded
+// member): in these cases the counter is a plain int avoiding locked
+// read-modify-write operations. With a single-threaded scheduler stop
+// requests need to be made on the thread running the context, too: debug
+// builds check that when the stop callback is invoked.
+
+namespace stdnet::_Hidden
+{
+    template <typename _Scheduler>
+    concept _Single_threaded_scheduler
+        = requires{ requires ::std::remove_cvref_t<_Scheduler>::_Single_threaded; };
+
+    template <typename _Scheduler, typename _Stop_token>
+    using _Cpo_counter = ::std::conditional_t<
+        ::stdnet::_Hidden::_Single_threaded_scheduler<_Scheduler> || ::stdexec::unstoppable_token<_Stop_token>,
+        int,
+        ::std::atomic<int>
+        >;
+}
+
+// ----------------------------------------------------------------------------
+// A multishot operation (the _Data declares a constexpr _Multishot member)
+// stays active after a completion: each completion is delivered using the
+// _Data's _Deliver() and the receiver is only completed when the operation
+// ends. Ending due to a stop request completes with set_stopped(), ending
+// because the context cancelled the operation (e.g., the socket was closed
+// or the peer shut the connection down) completes with set_value().
+
+namespace stdnet::_Hidden
+{
+    template <typename _Data>
+    concept _Multishot_data
+        = requires{ requires ::std::remove_cvref_t<_Data>::_Multishot; };
+}
+
+// ----------------------------------------------------------------------------
+// A continued operation (the _Data declares a constexpr _Continued member)
+// may need more than one submission: after each completion the _Data's
+// _Continue() decides whether the operation is submitted again (e.g., a
+// read which hasn't seen its delimiter yet) or the receiver is completed.
+
+namespace stdnet::_Hidden
+{
+    template <typename _Data>
+    concept _Continued_data
+        = requires{ requires ::std::remove_cvref_t<_Data>::_Continued; };
+}
+
 // ----------------------------------------------------------------------------
 
 template <::stdexec::receiver _Receiver>
 struct _Cpo_State_base
 {
     _Receiver           _D_receiver;
-    ::std::atomic<int>  _D_outstanding{};
     template <::stdexec::receiver _RT>
     _Cpo_State_base(_RT&& _R)
         : _D_receiver(::std::forward<_RT>(_R))
@@ -77,42 +131,41 @@ struct _Cpo_State
     : _Desc::_Operation
     , _Cpo_State_base<_Receiver>
 {
+    // The stop callback is a _Cancel_node for the operation state itself:
+    // the state is recovered from the node's _Op.
     struct _Cancel_callback
-        : ::stdnet::_Hidden::_Io_base //-dk:TODO use a less heavy-weight base
+        : ::stdnet::_Hidden::_Cancel_node
     {
-        _Cpo_State* _D_state;
         _Cancel_callback(_Cpo_State* _S)
-            : ::stdnet::_Hidden::_Io_base(::stdnet::_Hidden::_Socket_id(), 0)
-            , _D_state(_S)
+            : ::stdnet::_Hidden::_Cancel_node(_S, +[](::stdnet::_Hidden::_Cancel_node* _Node)
+                {
+                    auto _State(static_cast<_Cpo_State*>(_Node->_Op));
+                    if (0u == --_State->_D_outstanding)
+                    {
+                        ::stdexec::set_stopped(::std::move(_State->_D_receiver));
+                    }
+                })
         {
         }
         auto operator()()
         {
-            if (1 < ++this->_D_state->_D_outstanding)
+            auto _State(static_cast<_Cpo_State*>(this->_Op));
+            if constexpr (::stdnet::_Hidden::_Single_threaded_scheduler<decltype(_State->_D_data._Get_scheduler())>)
             {
-                this->_D_state->_D_data._Get_scheduler()._Cancel(this, this->_D_state);
+                assert(_State->_D_data._Get_scheduler()._Get_context()->_Owned());
             }
-        }
-        auto _Complete() -> void override final
-        {
-            if (0u == --this->_D_state->_D_outstanding)
+            if (1 < ++_State->_D_outstanding)
             {
-                ::stdexec::set_stopped(::std::move(this->_D_state->_D_receiver));
+                _State->_D_data._Get_scheduler()._Cancel(this);
             }
         }
-        auto _Error(::std::error_code) -> void override final
-        {
-            this->_Complete();
-        }
-        auto _Cancel() -> void override final
-        {
-            this->_Complete();
-        }
     };
     using _Upstream_state_t = decltype(::stdexec::connect(::std::declval<_Upstream&>(), ::std::declval<_Upstream_receiver<_Receiver>>()));
     using _Stop_token = std::remove_cvref_t<decltype(::stdexec::get_stop_token(::stdexec::get_env(::std::declval<_Receiver const&>())))>;
     using _Callback = typename _Stop_token::template callback_type<_Cancel_callback>;
+    using _Counter = ::stdnet::_Hidden::_Cpo_counter<decltype(::std::declval<_Data&>()._Get_scheduler()), _Stop_token>;
 
+    _Counter                   _D_outstanding{};
     _Data                      _D_data;
     _Upstream_state_t          _D_state;
     ::std::optional<_Callback> _D_callback;
@@ -147,6 +200,28 @@ struct _Cpo_State
     }
     auto _Complete() -> void override final
     {
+        if constexpr (::stdnet::_Hidden::_Multishot_data<_Data>)
+        {
+            // The delivery may end the operation: nothing is accessed after it.
+            this->_D_data._Deliver(*this);
+            return;
+        }
+        if constexpr (::stdnet::_Hidden::_Continued_data<_Data>)
+        {
+            while (this->_D_data._Continue(*this))
+            {
+                if (::stdexec::get_stop_token(::stdexec::get_env(this->_D_receiver)).stop_requested())
+                {
+                    _D_callback.reset();
+                    this->_Cancel();
+                    return;
+                }
+                if (this->_D_data._Submit(this))
+                {
+                    return;
+                }
+            }
+        }
         _D_callback.reset();
         if (0 == --this->_D_outstanding)
         {
@@ -163,6 +238,22 @@ struct _Cpo_State
     }
     auto _Cancel() -> void override final
     {
+        if constexpr (::stdnet::_Hidden::_Multishot_data<_Data>)
+        {
+            _D_callback.reset();
+            if (0 == --this->_D_outstanding)
+            {
+                if (::stdexec::get_stop_token(::stdexec::get_env(this->_D_receiver)).stop_requested())
+                {
+                    ::stdexec::set_stopped(::std::move(this->_D_receiver));
+                }
+                else
+                {
+                    this->_D_data._Set_value(*this, ::std::move(this->_D_receiver));
+                }
+            }
+            return;
+        }
         if (0 == --this->_D_outstanding)
         {
             ::stdexec::set_stopped(::std::move(this->_D_receiver));
@@ -0,0 +1,253 @@
+// stdnet/dynamic_buffer.hpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+/*
+ * Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_STDNET_DYNAMIC_BUFFER
+#define INCLUDED_STDNET_DYNAMIC_BUFFER
+
+#include <stdnet/buffer.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace stdnet
+{
+    class dynamic_buffer;
+
+    namespace _Hidden
+    {
+        auto _Search(char const*, char const*, ::std::string_view) -> char const*;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// A dynamic_buffer holds the bytes received but not yet consumed in one
+// contiguous range followed by space for more bytes: prepare() provides the
+// space for the next receive, commit() appends the received bytes, and
+// consume() drops bytes from the front. Consuming only advances an offset:
+// the remaining bytes are moved to the front when more space is needed and
+// the consumed prefix is at least as large as the remaining bytes, i.e.,
+// each byte is moved a constant number of times on average.
+
+class stdnet::dynamic_buffer
+{
+private:
+    ::std::unique_ptr<char[]> _D_data;
+    ::std::size_t             _D_capacity{};
+    ::std::size_t             _D_begin{};
+    ::std::size_t             _D_end{};
+    ::std::size_t             _D_max_size;
+
+public:
+    explicit dynamic_buffer(::std::size_t _Max_size = ::std::numeric_limits<::std::size_t>::max())
+        : _D_max_size(_Max_size)
+    {
+    }
+
+    auto size() const -> ::std::size_t { return this->_D_end - this->_D_begin; }
+    auto max_size() const -> ::std::size_t { return this->_D_max_size; }
+    auto capacity() const -> ::std::size_t { return this->_D_capacity; }
+    // tail_capacity() is the space after the bytes which prepare() can
+    // provide without moving or reallocating them.
+    auto tail_capacity() const -> ::std::size_t { return this->_D_capacity - this->_D_end; }
+    auto data() const -> ::stdnet::const_buffer
+    {
+        return ::stdnet::const_buffer(this->_D_data.get() + this->_D_begin, this->size());
+    }
+    auto view() const -> ::std::string_view
+    {
+        return ::std::string_view(this->_D_data.get() + this->_D_begin, this->size());
+    }
+
+    auto prepare(::std::size_t _Size) -> ::stdnet::mutable_buffer
+    {
+        ::std::size_t _Used(this->size());
+        if (this->_D_max_size - _Used < _Size)
+        {
+            throw ::std::length_error("dynamic_buffer too long");
+        }
+        if (this->tail_capacity() < _Size)
+        {
+            if (this->_D_capacity - _Used < _Size || this->_D_begin < _Used)
+            {
+                ::std::size_t _Capacity(::std::max(_Used + _Size, 2u * this->_D_capacity));
+                auto          _Data(::std::make_unique_for_overwrite<char[]>(_Capacity));
+                if (0u < _Used)
+                {
+                    ::std::memcpy(_Data.get(), this->_D_data.get() + this->_D_begin, _Used);
+                }
+                this->_D_data     = ::std::move(_Data);
+                this->_D_capacity = _Capacity;
+            }
+            else
+            {
+                ::std::memmove(this->_D_data.get(), this->_D_data.get() + this->_D_begin, _Used);
+            }
+            this->_D_begin = 0u;
+            this->_D_end   = _Used;
+        }
+        return ::stdnet::mutable_buffer(this->_D_data.get() + this->_D_end, _Size);
+    }
+    auto commit(::std::size_t _Size) -> void
+    {
+        this->_D_end += ::std::min(_Size, this->_D_capacity - this->_D_end);
+    }
+    auto consume(::std::size_t _Size) -> void
+    {
+        this->_D_begin += ::std::min(_Size, this->size());
+        if (this->_D_begin == this->_D_end)
+        {
+            this->_D_begin = this->_D_end = 0u;
+        }
+    }
+};
+
+template <>
+struct stdnet::is_dynamic_buffer<::stdnet::dynamic_buffer>
+    : ::std::true_type
+{
+};
+
+// ----------------------------------------------------------------------------
+// _Search() locates a delimiter in [_Begin, _End) and returns _End if it
+// isn't found. Multi-byte delimiters are located by comparing blocks of
+// bytes against the first and the last byte of the delimiter at once (the
+// block size depends on the available instructions: AVX2 is used when the
+// CPU supports it, SSE2 otherwise): only positions matching both are
+// compared completely.
+
+namespace stdnet::_Hidden
+{
+    inline auto _Search_bytes(char const* _Begin, char const* _End, ::std::string_view _Needle)
+        -> char const*
+    {
+        if (::std::size_t(_End - _Begin) < _Needle.size())
+        {
+            return _End;
+        }
+        for (char const* _Last(_End - _Needle.size() + 1); _Begin != _Last; ++_Begin)
+        {
+            _Begin = static_cast<char const*>(::std::memchr(_Begin, _Needle.front(), _Last - _Begin));
+            if (!_Begin)
+            {
+                return _End;
+            }
+            if (::std::memcmp(_Begin + 1, _Needle.data() + 1, _Needle.size() - 1u) == 0)
+            {
+                return _Begin;
+            }
+        }
+        return _End;
+    }
+
+#if defined(__SSE2__)
+    // _Candidates() checks the positions of a block whose bit is set in the
+    // mask, i.e., the positions where the first and the last byte match.
+    inline auto _Candidates(char const* _Begin, unsigned _Mask, ::std::string_view _Needle)
+        -> char const*
+    {
+        for (; _Mask != 0u; _Mask &= _Mask - 1u)
+        {
+            char const* _Candidate(_Begin + __builtin_ctz(_Mask));
+            if (::std::memcmp(_Candidate + 1, _Needle.data() + 1, _Needle.size() - 2u) == 0)
+            {
+                return _Candidate;
+            }
+        }
+        return nullptr;
+    }
+
+    inline auto _Search_sse2(char const* _Begin, char const* _End, ::std::string_view _Needle)
+        -> char const*
+    {
+        ::std::size_t const _Back(_Needle.size() - 1u);
+        __m128i const       _First(_mm_set1_epi8(_Needle.front()));
+        __m128i const       _Last(_mm_set1_epi8(_Needle.back()));
+        for (; _Back + 16u <= ::std::size_t(_End - _Begin); _Begin += 16)
+        {
+            __m128i _Front_bytes(_mm_loadu_si128(reinterpret_cast<__m128i const*>(_Begin)));
+            __m128i _Back_bytes(_mm_loadu_si128(reinterpret_cast<__m128i const*>(_Begin + _Back)));
+            unsigned _Mask(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(_First, _Front_bytes),
+                                                           _mm_cmpeq_epi8(_Last, _Back_bytes))));
+            if (char const* _Rc = ::stdnet::_Hidden::_Candidates(_Begin, _Mask, _Needle))
+            {
+                return _Rc;
+            }
+        }
+        return ::stdnet::_Hidden::_Search_bytes(_Begin, _End, _Needle);
+    }
+
+    __attribute__((target("avx2")))
+    inline auto _Search_avx2(char const* _Begin, char const* _End, ::std::string_view _Needle)
+        -> char const*
+    {
+        ::std::size_t const _Back(_Needle.size() - 1u);
+        __m256i const       _First(_mm256_set1_epi8(_Needle.front()));
+        __m256i const       _Last(_mm256_set1_epi8(_Needle.back()));
+        for (; _Back + 32u <= ::std::size_t(_End - _Begin); _Begin += 32)
+        {
+            __m256i _Front_bytes(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(_Begin)));
+            __m256i _Back_bytes(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(_Begin + _Back)));
+            unsigned _Mask(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(_First, _Front_bytes),
+                                                                 _mm256_cmpeq_epi8(_Last, _Back_bytes))));
+            if (char const* _Rc = ::stdnet::_Hidden::_Candidates(_Begin, _Mask, _Needle))
+            {
+                return _Rc;
+            }
+        }
+        return ::stdnet::_Hidden::_Search_bytes(_Begin, _End, _Needle);
+    }
+#endif
+}
+
+inline auto stdnet::_Hidden::_Search(char const* _Begin, char const* _End, ::std::string_view _Needle)
+    -> char const*
+{
+    if (_Needle.empty())
+    {
+        return _Begin;
+    }
+    if (_Needle.size() == 1u)
+    {
+        auto _Rc(static_cast<char const*>(::std::memchr(_Begin, _Needle.front(), _End - _Begin)));
+        return _Rc? _Rc: _End;
+    }
+#if defined(__SSE2__)
+    static bool const _Avx2(__builtin_cpu_supports("avx2"));
+    return _Avx2
+        ? ::stdnet::_Hidden::_Search_avx2(_Begin, _End, _Needle)
+        : ::stdnet::_Hidden::_Search_sse2(_Begin, _End, _Needle)
+        ;
+#else
+    return ::stdnet::_Hidden::_Search_bytes(_Begin, _End, _Needle);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,695 @@
+// stdnet/epoll_context.hpp                                           -*-C++-*-
+// ----------------------------------------------------------------------------
+/*
+ * Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_STDNET_EPOLL_CONTEXT
+#define INCLUDED_STDNET_EPOLL_CONTEXT
+
+#include <stdnet/netfwd.hpp>
+#include <stdnet/container.hpp>
+#include <stdnet/context_base.hpp>
+#include <stdnet/event_fd.hpp>
+#include <stdnet/io_work.hpp>
+#include <stdnet/timer_wheel.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <system_error>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+
+namespace stdnet::_Hidden
+{
+    struct _Epoll_record;
+    class _Epoll_context;
+}
+
+// ----------------------------------------------------------------------------
+// A socket is only registered with epoll while operations wait for it: the
+// kernel reports EPOLLHUP and EPOLLERR even for an empty interest set, i.e.,
+// an idle socket whose peer closed the connection would wake every
+// epoll_wait(). The interest set is only changed when an operation needs an
+// event which isn't registered, yet, and it is dropped lazily when an event
+// arrives without an operation waiting for it, removing the socket once no
+// event is left: a steady stream of receives doesn't cause any epoll_ctl()
+// calls.
+
+struct stdnet::_Hidden::_Epoll_record final
+{
+    bool                                                   _Blocking{true};
+    bool                                                   _Speculative{false};
+    ::std::uint32_t                                        _Events{};   // interest registered with epoll, if any
+    ::stdnet::_Hidden::_Io_queue                           _Readers;
+    ::stdnet::_Hidden::_Io_queue                           _Writers;
+};
+
+// ----------------------------------------------------------------------------
+
+class stdnet::_Hidden::_Epoll_context final
+    : public ::stdnet::_Hidden::_Context_base
+{
+private:
+    // basic_io_context<_Epoll_context> calls the functions directly.
+    template <typename> friend class ::stdnet::basic_io_context;
+    template <typename> friend class ::stdnet::_Hidden::_Static_scheduler;
+
+    using _Clock = ::std::chrono::steady_clock;
+
+    ::stdnet::_Hidden::_Container<::stdnet::_Hidden::_Epoll_record> _D_sockets;
+    int                                                             _D_fd;
+    ::stdnet::_Hidden::_Event_fd                                    _D_wakeup;
+    ::std::vector<::epoll_event>                                    _D_events;
+    ::std::vector<::stdnet::_Hidden::_Io_base*>                     _D_ready;
+    ::std::size_t                                                   _D_next{};
+    ::std::size_t                                                   _D_waiting{};
+    ::stdnet::_Hidden::_Timer_wheel                                 _D_timers;
+    ::stdnet::_Hidden::_Speculation                                 _D_speculation;
+
+    auto _Make_socket(int, bool) -> ::stdnet::_Hidden::_Socket_id override;
+    auto _Make_socket(int, int, int, ::std::error_code&) -> ::stdnet::_Hidden::_Socket_id override;
+    auto _Release(::stdnet::_Hidden::_Socket_id, ::std::error_code&) -> void override;
+    auto _Native_handle(::stdnet::_Hidden::_Socket_id) -> _Stdnet_native_handle_type override;
+    auto _Set_option(::stdnet::_Hidden::_Socket_id, int, int, void const*, ::socklen_t, ::std::error_code&) -> void override;
+    auto _Bind(::stdnet::_Hidden::_Socket_id, ::stdnet::_Hidden::_Endpoint const&, ::std::error_code&) -> void override;
+    auto _Listen(::stdnet::_Hidden::_Socket_id, int, ::std::error_code&) -> void override;
+
+    auto run_one() -> ::std::size_t override;
+    auto _Run_some(::std::size_t, _Clock::time_point) -> ::std::size_t override;
+    auto _Wakeup() -> void override;
+
+    auto _Cancel(::stdnet::_Hidden::_Cancel_node*) -> void override;
+    auto _Accept(::stdnet::_Hidden::_Context_base::_Accept_operation*) -> bool override;
+    auto _Accept_multishot(::stdnet::_Hidden::_Context_base::_Accept_operation*) -> bool override;
+    auto _Connect(::stdnet::_Hidden::_Context_base::_Connect_operation*) -> bool override;
+    auto _Receive(::stdnet::_Hidden::_Context_base::_Receive_operation*) -> bool override;
+    auto _Receive_multishot(::stdnet::_Hidden::_Context_base::_Receive_multishot_operation*) -> bool override;
+    auto _Send(::stdnet::_Hidden::_Context_base::_Send_operation*) -> bool override;
+    auto _Sendfile(::stdnet::_Hidden::_Context_base::_Sendfile_operation*) -> bool override;
+    auto _Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation*) -> bool override;
+    auto _Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation*) -> bool override;
+
+    auto _Enqueue(::stdnet::_Hidden::_Io_base*, ::std::uint32_t) -> bool;
+    template <typename _Try>
+    auto _Submit(::stdnet::_Hidden::_Io_base*, ::std::uint32_t, _Try) -> bool;
+    auto _Update(::stdnet::_Hidden::_Socket_id, ::std::uint32_t) -> ::std::error_code;
+    auto _Ready_next(::stdnet::_Hidden::_Socket_id) -> void;
+    template <auto _Try>
+    static auto _Multishot_work(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> bool;
+    auto _Add_timer(::stdnet::_Hidden::_Io_base*, _Timer_storage&, _Clock::time_point) -> void;
+    auto _Arm_deadline(::stdnet::_Hidden::_Io_base*) -> void;
+    auto _Disarm_deadline(::stdnet::_Hidden::_Io_base*) -> void;
+    auto _Expired(::stdnet::_Hidden::_Io_base*) -> void;
+    auto _Wait(_Clock::time_point) -> bool;
+
+public:
+    _Epoll_context();
+    _Epoll_context(_Epoll_context&&) = delete;
+    ~_Epoll_context();
+};
+
+// ----------------------------------------------------------------------------
+
+inline stdnet::_Hidden::_Epoll_context::_Epoll_context()
+    : _D_fd(::epoll_create1(EPOLL_CLOEXEC))
+    , _D_events(64u)
+{
+    // The wakeup descriptor is registered using the invalid socket id.
+    ::epoll_event _Event{ .events = EPOLLIN, .data = { .u64 = ::std::uint64_t(::stdnet::_Hidden::_Socket_id::_Invalid) } };
+    if (this->_D_fd < 0 || ::epoll_ctl(this->_D_fd, EPOLL_CTL_ADD, this->_D_wakeup._Native_handle(), &_Event) < 0)
+    {
+        int _Errno(errno);
+        if (0 <= this->_D_fd)
+        {
+            ::close(this->_D_fd);
+        }
+        throw ::std::system_error(::std::error_code(_Errno, ::std::system_category()));
+    }
+}
+
+inline stdnet::_Hidden::_Epoll_context::~_Epoll_context()
+{
+    ::close(this->_D_fd);
+}
+
+// ----------------------------------------------------------------------------
+
+inline auto stdnet::_Hidden::_Epoll_context::_Make_socket(int _Fd, bool _Blocking) -> ::stdnet::_Hidden::_Socket_id
+{
+    auto _Id(this->_D_sockets._Insert(_Fd));
+    this->_D_sockets[_Id]._Blocking = _Blocking;
+    return _Id;
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Make_socket(int _D, int _T, int _P, ::std::error_code& _Error)
+    -> ::stdnet::_Hidden::_Socket_id
+{
+    int _Fd(::socket(_D, _T, _P));
+    if (_Fd < 0)
+    {
+        _Error = ::std::error_code(errno, ::std::system_category());
+        return ::stdnet::_Hidden::_Socket_id::_Invalid;
+    }
+    return this->_Make_socket(_Fd, true);
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Release(::stdnet::_Hidden::_Socket_id _Id, ::std::error_code& _Error) -> void
+{
+    if (!this->_D_sockets._Valid(_Id))
+    {
+        _Error = ::std::error_code(EBADF, ::std::system_category());
+        return;
+    }
+    auto& _Record(this->_D_sockets[_Id]);
+    _Stdnet_native_handle_type _Handle(this->_D_sockets._Handle(_Id));
+    ::stdnet::_Hidden::_Io_queue _Pending;
+    for (auto* _Queue: { &_Record._Readers, &_Record._Writers })
+    {
+        while (::stdnet::_Hidden::_Io_base* _Op = _Queue->_Pop())
+        {
+            --this->_D_waiting;
+            this->_Disarm_deadline(_Op);
+            _Pending._Push(_Op);
+        }
+    }
+    for (::std::size_t _I(this->_D_next); _I != this->_D_ready.size(); ++_I)
+    {
+        if (this->_D_ready[_I] && this->_D_ready[_I]->_Event != 0 && this->_D_ready[_I]->_Id == _Id)
+        {
+            _Pending._Push(::std::exchange(this->_D_ready[_I], nullptr));
+        }
+    }
+    this->_D_sockets._Erase(_Id);
+    // closing the descriptor also removes it from the epoll set
+    if (::close(_Handle) < 0)
+    {
+        _Error = ::std::error_code(errno, ::std::system_category());
+    }
+    while (::stdnet::_Hidden::_Io_base* _Op = _Pending._Pop())
+    {
+        _Op->_Cancel();
+    }
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Native_handle(::stdnet::_Hidden::_Socket_id _Id) -> _Stdnet_native_handle_type
+{
+    return this->_D_sockets._Handle(_Id);
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Set_option(::stdnet::_Hidden::_Socket_id _Id,
+                                                      int                           _Level,
+                                                      int                           _Name,
+                                                      void const*                   _Data,
+                                                      ::socklen_t                   _Size,
+                                                      ::std::error_code&            _Error)
+    -> void
+{
+    if (_Level == ::stdnet::_Hidden::_Stdnet_option_level && _Name == ::stdnet::_Hidden::_Speculative_io_option)
+    {
+        ::stdnet::_Hidden::_Set_speculative(this->_D_sockets[_Id], this->_D_sockets._Handle(_Id), _Data, _Size, _Error);
+        return;
+    }
+    if (::setsockopt(this->_Native_handle(_Id), _Level, _Name, _Data, _Size) < 0)
+    {
+        _Error = ::std::error_code(errno, ::std::system_category());
+    }
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Bind(::stdnet::_Hidden::_Socket_id _Id,
+                                                ::stdnet::_Hidden::_Endpoint const& _Endpoint,
+                                                ::std::error_code& _Error)
+            -> void
+{
+    if (::bind(this->_Native_handle(_Id), _Endpoint._Data(), _Endpoint._Size()) < 0)
+    {
+        _Error = ::std::error_code(errno, ::std::system_category());
+    }
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Listen(::stdnet::_Hidden::_Socket_id _Id,
+                                                  int                           _No,
+                                                  ::std::error_code&            _Error)
+    -> void
+{
+    if (::listen(this->_Native_handle(_Id), _No) < 0)
+    {
+        _Error = ::std::error_code(errno, ::std::system_category());
+        return;
+    }
+    // A non-blocking listener allows draining the backlog (see _Accept()).
+    ::stdnet::_Hidden::_Set_nonblocking(this->_D_sockets[_Id], this->_D_sockets._Handle(_Id), _Error);
+}
+
+// ----------------------------------------------------------------------------
+// _Run_some() completes operations from the ready list. Only when the ready
+// list is exhausted epoll_wait() is called to refill it with all operations
+// which became ready.
+
+inline auto stdnet::_Hidden::_Epoll_context::run_one() -> ::std::size_t
+{
+    return this->_Run_some(1u, _Clock::time_point::max());
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Run_some(::std::size_t _Max, _Clock::time_point _Deadline) -> ::std::size_t
+{
+    this->_D_speculation._Reset();
+    this->_Update_now();
+    ::std::size_t _Count(this->_Run_posted());
+    bool          _Waited{false};
+    while (true)
+    {
+        while (_Count < _Max && this->_D_next != this->_D_ready.size())
+        {
+            ::stdnet::_Hidden::_Io_base* _Op(this->_D_ready[this->_D_next++]);
+            if (_Op == nullptr)
+            {
+                continue;
+            }
+            if (_Op->_Work(*this, _Op))
+            {
+                ++_Count;
+            }
+            else
+            {
+                this->_Enqueue(_Op, _Op->_Event);
+            }
+        }
+        if (this->_D_next == this->_D_ready.size())
+        {
+            this->_D_ready.clear();
+            this->_D_next = 0u;
+        }
+
+        if (_Count != 0u)
+        {
+            return _Count;
+        }
+        if (this->_D_waiting == 0u && this->_D_timers._Empty())
+        {
+            return ::std::size_t{};
+        }
+        if ((_Waited && _Deadline <= this->_Now()) || !this->_Wait(_Deadline))
+        {
+            return ::std::size_t{};
+        }
+        _Waited = true;
+        _Count = this->_Run_posted();
+    }
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Wakeup() -> void
+{
+    this->_D_wakeup._Signal();
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Wait(_Clock::time_point _Deadline) -> bool
+{
+    _Deadline = ::std::min(_Deadline, this->_D_timers._Next());
+    int _Timeout(-1);
+    if (_Deadline != _Clock::time_point::max())
+    {
+        auto _Now(this->_Update_now());
+        _Timeout = _Deadline <= _Now
+            ? 0
+            : int(::std::min<::std::chrono::milliseconds::rep>(
+                ::std::chrono::ceil<::std::chrono::milliseconds>(_Deadline - _Now).count(),
+                ::std::numeric_limits<int>::max()));
+    }
+
+    int _Rc(::epoll_wait(this->_D_fd, this->_D_events.data(), int(this->_D_events.size()), _Timeout));
+    if (_Rc < 0)
+    {
+        return errno == EINTR;
+    }
+
+    for (int _I{}; _I != _Rc; ++_I)
+    {
+        ::epoll_event const& _Event(this->_D_events[_I]);
+        auto _Id(::stdnet::_Hidden::_Socket_id(_Event.data.u64));
+        if (_Id == ::stdnet::_Hidden::_Socket_id::_Invalid)
+        {
+            this->_D_wakeup._Drain();
+            continue;
+        }
+        auto& _Record(this->_D_sockets[_Id]);
+        ::std::uint32_t _Drop{};
+
+        if (_Event.events & (EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+        {
+            if (_Record._Readers._Empty())
+            {
+                _Drop |= EPOLLIN;
+            }
+            else
+            {
+                --this->_D_waiting;
+                this->_D_ready.push_back(_Record._Readers._Pop());
+                this->_Disarm_deadline(this->_D_ready.back());
+            }
+        }
+        if (_Event.events & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+        {
+            if (_Record._Writers._Empty())
+            {
+                _Drop |= EPOLLOUT;
+            }
+            else
+            {
+                --this->_D_waiting;
+                this->_D_ready.push_back(_Record._Writers._Pop());
+                this->_Disarm_deadline(this->_D_ready.back());
+            }
+        }
+        if (_Drop & _Record._Events)
+        {
+            this->_Update(_Id, _Record._Events & ~_Drop);
+        }
+    }
+    if (::std::size_t(_Rc) == this->_D_events.size())
+    {
+        this->_D_events.resize(2u * this->_D_events.size());
+    }
+
+    this->_Update_now();
+    if (!this->_D_timers._Empty())
+    {
+        this->_D_timers._Expire(this->_Now(), [this](::stdnet::_Hidden::_Io_base* _Op){ this->_Expired(_Op); });
+    }
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Update(::stdnet::_Hidden::_Socket_id _Id, ::std::uint32_t _Events)
+    -> ::std::error_code
+{
+    auto& _Record(this->_D_sockets[_Id]);
+    int   _Ctl(_Record._Events == 0u? EPOLL_CTL_ADD: _Events == 0u? EPOLL_CTL_DEL: EPOLL_CTL_MOD);
+    ::epoll_event _Event{ .events = _Events, .data = { .u64 = ::std::uint64_t(_Id) } };
+    if (::epoll_ctl(this->_D_fd, _Ctl, this->_D_sockets._Handle(_Id), &_Event) < 0)
+    {
+        return ::std::error_code(errno, ::std::system_category());
+    }
+    _Record._Events = _Events;
+    return {};
+}
+
+// ----------------------------------------------------------------------------
+
+inline auto stdnet::_Hidden::_Epoll_context::_Enqueue(::stdnet::_Hidden::_Io_base* _Op, ::std::uint32_t _Events)
+    -> bool
+{
+    auto& _Record(this->_D_sockets[_Op->_Id]);
+    if ((_Record._Events & _Events) != _Events)
+    {
+        if (auto _Error = this->_Update(_Op->_Id, _Record._Events | _Events))
+        {
+            _Op->_Error(_Error);
+            return true;
+        }
+    }
+    _Op->_Context = this;
+    _Op->_Event   = _Events;
+    (_Events == EPOLLIN? _Record._Readers: _Record._Writers)._Push(_Op);
+    ++this->_D_waiting;
+    this->_Arm_deadline(_Op);
+    return true;
+}
+
+// Socket operations with a deadline have a timer node in their deadline
+// storage while they are waiting. When the timer expires first, the operation
+// is removed from its queue and completes with a timeout.
+
+inline auto stdnet::_Hidden::_Epoll_context::_Arm_deadline(::stdnet::_Hidden::_Io_base* _Op) -> void
+{
+    static_assert(sizeof(::stdnet::_Hidden::_Timer_node) <= sizeof(_Timer_storage));
+    if (_Op->_Deadline)
+    {
+        auto _Node(::new(static_cast<void*>(_Op->_Deadline->_Storage._Data)) ::stdnet::_Hidden::_Timer_node());
+        _Node->_Op = _Op;
+        this->_D_timers._Insert(_Node, _Op->_Deadline->_Resolve(this->_Now()));
+    }
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Disarm_deadline(::stdnet::_Hidden::_Io_base* _Op) -> void
+{
+    if (_Op->_Deadline)
+    {
+        this->_D_timers._Erase(::std::launder(reinterpret_cast<::stdnet::_Hidden::_Timer_node*>(_Op->_Deadline->_Storage._Data)));
+    }
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Expired(::stdnet::_Hidden::_Io_base* _Op) -> void
+{
+    if (_Op->_Event != 0)
+    {
+        auto& _Record(this->_D_sockets[_Op->_Id]);
+        (_Op->_Event == EPOLLIN? _Record._Readers: _Record._Writers)._Erase(_Op);
+        --this->_D_waiting;
+        _Op->_Work = ::stdnet::_Hidden::_Timeout_work;
+    }
+    this->_D_ready.push_back(_Op);
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Add_timer(::stdnet::_Hidden::_Io_base* _Op,
+                                                      _Timer_storage&              _Storage,
+                                                      _Clock::time_point           _Time)
+    -> void
+{
+    static_assert(sizeof(::stdnet::_Hidden::_Timer_node) <= sizeof(_Timer_storage));
+    _Op->_Context = this;
+    _Op->_Event   = 0;
+    _Op->_Work    = [](::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base* _Op)
+        {
+            _Op->_Complete();
+            return true;
+        };
+    auto _Node(::new(static_cast<void*>(_Storage._Data)) ::stdnet::_Hidden::_Timer_node());
+    _Node->_Op  = _Op;
+    _Op->_Extra = ::stdnet::_Hidden::_Io_base::_Extra_t(_Node, +[](void*){});
+    this->_D_timers._Insert(_Node, _Time);
+}
+
+// ----------------------------------------------------------------------------
+
+inline auto stdnet::_Hidden::_Epoll_context::_Cancel(::stdnet::_Hidden::_Cancel_node* _Node) -> void
+{
+    ::stdnet::_Hidden::_Io_base* _Op(_Node->_Op);
+    bool _Found{false};
+    if (_Op->_Event == 0)
+    {
+        _Found = this->_D_timers._Erase(static_cast<::stdnet::_Hidden::_Timer_node*>(_Op->_Extra.get()));
+    }
+    else if (this->_D_sockets._Valid(_Op->_Id)) // a posted cancellation may arrive after _Release()
+    {
+        auto& _Record(this->_D_sockets[_Op->_Id]);
+        if ((_Op->_Event == EPOLLIN? _Record._Readers: _Record._Writers)._Erase(_Op))
+        {
+            --this->_D_waiting;
+            this->_Disarm_deadline(_Op);
+            _Found = true;
+        }
+    }
+    for (::std::size_t _I(this->_D_next); !_Found && _I != this->_D_ready.size(); ++_I)
+    {
+        if (this->_D_ready[_I] == _Op)
+        {
+            this->_D_ready[_I] = nullptr;
+            _Found = true;
+        }
+    }
+    // The operation may have completed already if the cancellation was
+    // posted from another thread.
+    _Node->_Done(_Node);
+    if (_Found)
+    {
+        _Op->_Cancel();
+    }
+}
+
+// _Submit() tries the operation right away if speculative I/O is enabled for
+// the socket and no other operation is waiting in the same direction.
+
+template <typename _Try>
+inline auto stdnet::_Hidden::_Epoll_context::_Submit(::stdnet::_Hidden::_Io_base* _Op, ::std::uint32_t _Events, _Try _T)
+    -> bool
+{
+    auto& _Record(this->_D_sockets[_Op->_Id]);
+    bool _Idle((_Events == EPOLLIN? _Record._Readers: _Record._Writers)._Empty());
+    if (auto _Rc = this->_D_speculation._Attempt(_Record._Speculative && _Idle, *this, _Op, _T))
+    {
+        return *_Rc;
+    }
+    return this->_Enqueue(_Op, _Events);
+}
+
+// Once a waiting accept got a connection, the next waiting accept on the same
+// listener is made ready, too: a burst of connections is accepted without an
+// epoll_wait() per connection. The accept failing with EWOULDBLOCK ends the
+// chain and the operation waits again.
+
+inline auto stdnet::_Hidden::_Epoll_context::_Accept(::stdnet::_Hidden::_Context_base::_Accept_operation* _Op) -> bool
+{
+    _Op->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+        {
+            auto _Result(::stdnet::_Hidden::_Try_accept(_Ctxt, _Op));
+            if (_Result == ::stdnet::_Hidden::_Io_result::_Done)
+            {
+                static_cast<::stdnet::_Hidden::_Epoll_context&>(_Ctxt)._Ready_next(_Op->_Id);
+            }
+            return ::stdnet::_Hidden::_Finish_work(_Result, _Op);
+        };
+    return this->_Submit(_Op, EPOLLIN, ::stdnet::_Hidden::_Try_accept);
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Ready_next(::stdnet::_Hidden::_Socket_id _Id) -> void
+{
+    auto& _Record(this->_D_sockets[_Id]);
+    if (!_Record._Blocking && !_Record._Readers._Empty())
+    {
+        --this->_D_waiting;
+        this->_D_ready.push_back(_Record._Readers._Pop());
+        this->_Disarm_deadline(this->_D_ready.back());
+    }
+}
+
+// A multishot operation is queued again before each completion: the
+// completion may release the socket or cancel the operation which needs to
+// find it. Together with _Ready_next() the operation is repeated until it
+// would block, e.g., a multishot accept accepts the whole backlog.
+
+template <auto _Try>
+inline auto stdnet::_Hidden::_Epoll_context::_Multishot_work(::stdnet::_Hidden::_Context_base& _Ctxt,
+                                                             ::stdnet::_Hidden::_Io_base* _Op)
+    -> bool
+{
+    auto _Result(_Try(_Ctxt, _Op));
+    if (_Result != ::stdnet::_Hidden::_Io_result::_Done)
+    {
+        return _Result == ::stdnet::_Hidden::_Io_result::_Failed;
+    }
+    auto& _Context(static_cast<::stdnet::_Hidden::_Epoll_context&>(_Ctxt));
+    _Context._D_sockets[_Op->_Id]._Readers._Push(_Op);
+    ++_Context._D_waiting;
+    _Context._Ready_next(_Op->_Id);
+    _Op->_Complete();
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Accept_multishot(::stdnet::_Hidden::_Context_base::_Accept_operation* _Op) -> bool
+{
+    _Op->_Work = _Multishot_work<::stdnet::_Hidden::_Try_accept>;
+    return this->_Enqueue(_Op, EPOLLIN);
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Connect(::stdnet::_Hidden::_Context_base::_Connect_operation* _Op) -> bool
+{
+    auto& _Record(this->_D_sockets[_Op->_Id]);
+    auto _Handle(this->_D_sockets._Handle(_Op->_Id));
+    auto const& _Endpoint(::std::get<0>(*_Op));
+    int _Flags(::fcntl(_Handle, F_GETFL));
+    if (_Flags < 0 || ::fcntl(_Handle, F_SETFL, _Flags | O_NONBLOCK) < 0)
+    {
+        _Op->_Error(::std::error_code(errno, ::std::system_category()));
+        return true;
+    }
+    _Record._Blocking = false;
+    if (0 == ::connect(_Handle, _Endpoint._Data(), _Endpoint._Size()))
+    {
+        return false;
+    }
+    switch (errno)
+    {
+    default:
+        _Op->_Error(::std::error_code(errno, ::std::system_category()));
+        return true;
+    case EINPROGRESS:
+    case EINTR:
+        break;
+    }
+
+    _Op->_Work = ::stdnet::_Hidden::_Connect_work;
+    return this->_Enqueue(_Op, EPOLLOUT);
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Receive(::stdnet::_Hidden::_Context_base::_Receive_operation* _Op) -> bool
+{
+    _Op->_Work = ::stdnet::_Hidden::_Receive_work;
+    return this->_Submit(_Op, EPOLLIN, ::stdnet::_Hidden::_Try_receive);
+}
+
+// The socket is made non-blocking such that the multishot receive can be
+// repeated until it would block.
+
+inline auto stdnet::_Hidden::_Epoll_context::_Receive_multishot(::stdnet::_Hidden::_Context_base::_Receive_multishot_operation* _Op) -> bool
+{
+    ::std::error_code _Error;
+    ::stdnet::_Hidden::_Set_nonblocking(this->_D_sockets[_Op->_Id], this->_D_sockets._Handle(_Op->_Id), _Error);
+    if (_Error)
+    {
+        _Op->_Error(_Error);
+        return true;
+    }
+    _Op->_Work = _Multishot_work<::stdnet::_Hidden::_Try_receive_multishot>;
+    return this->_Enqueue(_Op, EPOLLIN);
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Send(::stdnet::_Hidden::_Context_base::_Send_operation* _Op) -> bool
+{
+    _Op->_Work = ::stdnet::_Hidden::_Send_work;
+    return this->_Submit(_Op, EPOLLOUT, ::stdnet::_Hidden::_Try_send);
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Sendfile(::stdnet::_Hidden::_Context_base::_Sendfile_operation* _Op) -> bool
+{
+    ::std::error_code _Error;
+    ::stdnet::_Hidden::_Set_nonblocking(this->_D_sockets[_Op->_Id], this->_D_sockets._Handle(_Op->_Id), _Error);
+    if (_Error)
+    {
+        _Op->_Error(_Error);
+        return true;
+    }
+    _Op->_Work = ::stdnet::_Hidden::_Sendfile_work;
+    return this->_Submit(_Op, EPOLLOUT, ::stdnet::_Hidden::_Try_sendfile);
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation* _Op) -> bool
+{
+    this->_Add_timer(_Op, ::std::get<1>(*_Op), this->_Now() + ::std::get<0>(*_Op));
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Epoll_context::_Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation* _Op) -> bool
+{
+    auto _Time(::std::get<0>(*_Op));
+    if (_Time <= this->_Now())
+    {
+        return false;
+    }
+    this->_Add_timer(_Op, ::std::get<1>(*_Op), _Time);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
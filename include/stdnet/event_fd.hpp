@@ -0,0 +1,77 @@
+// stdnet/event_fd.hpp                                                -*-C++-*-
+// ----------------------------------------------------------------------------
+/*
+ * Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_STDNET_EVENT_FD
+#define INCLUDED_STDNET_EVENT_FD
+
+#include <stdnet/netfwd.hpp>
+#include <cstdint>
+#include <system_error>
+#include <cerrno>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+
+namespace stdnet::_Hidden
+{
+    class _Event_fd;
+}
+
+// ----------------------------------------------------------------------------
+// The class _Event_fd owns an eventfd which is used to wake up a context
+// waiting for events from another thread. By default it is non-blocking.
+
+class stdnet::_Hidden::_Event_fd
+{
+private:
+    int _D_fd;
+
+public:
+    explicit _Event_fd(int _Flags = EFD_NONBLOCK | EFD_CLOEXEC)
+        : _D_fd(::eventfd(0u, _Flags))
+    {
+        if (this->_D_fd < 0)
+        {
+            throw ::std::system_error(::std::error_code(errno, ::std::system_category()));
+        }
+    }
+    _Event_fd(_Event_fd&&) = delete;
+    ~_Event_fd() { ::close(this->_D_fd); }
+
+    auto _Native_handle() const -> int { return this->_D_fd; }
+    auto _Signal() -> void
+    {
+        ::std::uint64_t _Value(1u);
+        while (::write(this->_D_fd, &_Value, sizeof(_Value)) < 0 && errno == EINTR)
+        {
+        }
+    }
+    auto _Drain() -> void
+    {
+        ::std::uint64_t _Value;
+        while (::read(this->_D_fd, &_Value, sizeof(_Value)) < 0 && errno == EINTR)
+        {
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -203,7 +203,7 @@ public:
     auto to_string(Allocator const& = {}) const
         -> ::std::basic_string<char, ::std::char_traits<char>, Allocator>;
 
-    friend ::std::ostream& operator<< (::std::ostream& _Out, address_v6 const& _A)
+    friend ::std::ostream& operator<< (::std::ostream& _Out, address_v6 const&)
     {
         return _Out << "::1";
     }
@@ -21,13 +21,19 @@
 #define INCLUDED_STDNET_IO_BASE
 
 #include <stdnet/netfwd.hpp>
+#include <atomic>
 #include <memory>
 #include <system_error>
+#include <utility>
 
 // ----------------------------------------------------------------------------
 
 namespace stdnet::_Hidden {
     struct _Io_base;
+    struct _Cancel_node;
+    struct _Io_deadline;
+    struct _Io_queue;
+    struct _Io_mpsc_queue;
     template <typename _Data> struct _Io_operation;
 }
 
@@ -46,6 +52,7 @@ struct stdnet::_Hidden::_Io_base
     int                               _Event;         // mask for expected events
     auto                            (*_Work)(::stdnet::_Hidden::_Context_base&, _Io_base*) -> bool = nullptr;
     _Extra_t                          _Extra{nullptr, +[](void*){}};
+    ::stdnet::_Hidden::_Io_deadline*  _Deadline{nullptr}; // optional completion deadline
 
     _Io_base(::stdnet::_Hidden::_Socket_id _Id, int _Event): _Id(_Id), _Event(_Event) {}
 
@@ -54,6 +61,114 @@ struct stdnet::_Hidden::_Io_base
     virtual auto _Cancel() -> void = 0;
 };
 
+// ----------------------------------------------------------------------------
+// The struct _Cancel_node is a request to cancel the operation _Op. Once the
+// context processed the request, it calls _Done, whether or not the operation
+// was still pending. While the request is posted to a context from another
+// thread the node is linked via _Next.
+
+struct stdnet::_Hidden::_Cancel_node
+{
+    _Cancel_node*                _Next{nullptr};
+    ::stdnet::_Hidden::_Io_base* _Op;
+    auto                       (*_Done)(_Cancel_node*) -> void;
+
+    _Cancel_node(::stdnet::_Hidden::_Io_base* _Op, auto (*_Done)(_Cancel_node*) -> void): _Op(_Op), _Done(_Done) {}
+};
+
+
+// ----------------------------------------------------------------------------
+// The struct _Io_queue is an intrusive FIFO of _Io_base objects linked via
+// _Next. It is used by contexts to keep the operations waiting on a socket.
+
+struct stdnet::_Hidden::_Io_queue
+{
+    ::stdnet::_Hidden::_Io_base* _Head{nullptr};
+    ::stdnet::_Hidden::_Io_base* _Tail{nullptr};
+
+    auto _Empty() const -> bool { return this->_Head == nullptr; }
+    auto _Push(::stdnet::_Hidden::_Io_base* _Op) -> void
+    {
+        _Op->_Next = nullptr;
+        (this->_Head? this->_Tail->_Next: this->_Head) = _Op;
+        this->_Tail = _Op;
+    }
+    auto _Push_front(::stdnet::_Hidden::_Io_base* _Op) -> void
+    {
+        _Op->_Next = this->_Head;
+        this->_Head = _Op;
+        if (this->_Tail == nullptr)
+        {
+            this->_Tail = _Op;
+        }
+    }
+    auto _Pop() -> ::stdnet::_Hidden::_Io_base*
+    {
+        ::stdnet::_Hidden::_Io_base* _Op(this->_Head);
+        if (_Op)
+        {
+            this->_Head = ::std::exchange(_Op->_Next, nullptr);
+            if (this->_Head == nullptr)
+            {
+                this->_Tail = nullptr;
+            }
+        }
+        return _Op;
+    }
+    auto _Erase(::stdnet::_Hidden::_Io_base* _Op) -> bool
+    {
+        ::stdnet::_Hidden::_Io_base* _Prev(nullptr);
+        for (::stdnet::_Hidden::_Io_base* _It(this->_Head); _It; _Prev = ::std::exchange(_It, _It->_Next))
+        {
+            if (_It == _Op)
+            {
+                (_Prev? _Prev->_Next: this->_Head) = _Op->_Next;
+                if (this->_Tail == _Op)
+                {
+                    this->_Tail = _Prev;
+                }
+                _Op->_Next = nullptr;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// ----------------------------------------------------------------------------
+// The struct _Io_mpsc_queue is a lock-free intrusive multi-producer,
+// single-consumer queue of _Io_base objects linked via _Next. It is used to
+// hand operations to a context from other threads: producers push onto a
+// stack and the consumer takes all entries at once, restoring their order.
+
+struct stdnet::_Hidden::_Io_mpsc_queue
+{
+    ::std::atomic<::stdnet::_Hidden::_Io_base*> _Head{nullptr};
+
+    auto _Empty() const -> bool { return this->_Head.load(::std::memory_order_relaxed) == nullptr; }
+    // _Push() returns true if the queue was empty, i.e., if the consumer
+    // needs to be notified.
+    auto _Push(::stdnet::_Hidden::_Io_base* _Op) -> bool
+    {
+        ::stdnet::_Hidden::_Io_base* _Old(this->_Head.load(::std::memory_order_relaxed));
+        do
+        {
+            _Op->_Next = _Old;
+        }
+        while (!this->_Head.compare_exchange_weak(_Old, _Op, ::std::memory_order_release, ::std::memory_order_relaxed));
+        return _Old == nullptr;
+    }
+    auto _Take() -> ::stdnet::_Hidden::_Io_queue
+    {
+        ::stdnet::_Hidden::_Io_queue _Rc;
+        ::stdnet::_Hidden::_Io_base* _Op(this->_Head.exchange(nullptr, ::std::memory_order_acquire));
+        while (_Op)
+        {
+            _Rc._Push_front(::std::exchange(_Op, _Op->_Next));
+        }
+        return _Rc;
+    }
+};
 
 // ----------------------------------------------------------------------------
 // The struct _Io_operation is an _Io_base storing operation specific data.
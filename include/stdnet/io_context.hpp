@@ -25,9 +25,13 @@
 #include <stdnet/context_base.hpp>
 #include <stdnet/io_context_scheduler.hpp>
 #include <stdnet/libevent_context.hpp>
+#include <stdnet/epoll_context.hpp>
 #include <stdnet/poll_context.hpp>
+#include <stdnet/uring_context.hpp>
 #include <stdnet/container.hpp>
+#include <chrono>
 #include <cstdint>
+#include <memory>
 #include <sys/socket.h>
 #include <unistd.h>
 #include <poll.h>
@@ -42,20 +46,77 @@ namespace stdnet
     class io_context;
 }
 
+// ----------------------------------------------------------------------------
+// The run loops are shared by io_context and basic_io_context<_Backend>. They
+// are implemented in terms of a function object calling _Run_some() of the
+// respective context.
+
+namespace stdnet::_Hidden
+{
+    template <typename _Run_some_t>
+    auto _Run_all(_Run_some_t _Run_some) -> ::std::size_t
+    {
+        ::std::size_t _Count{};
+        while (::std::size_t _C = _Run_some(::std::numeric_limits<::std::size_t>::max(),
+                                            ::std::chrono::steady_clock::time_point::max()))
+        {
+            _Count += _C;
+        }
+        return _Count;
+    }
+
+    template <typename _Run_some_t, typename _Clock, typename _Duration>
+    auto _Run_until(_Run_some_t _Run_some, ::std::chrono::time_point<_Clock, _Duration> const& _Time) -> ::std::size_t
+    {
+        ::std::size_t _Count{};
+        for (auto _Now(_Clock::now()); _Now < _Time; _Now = _Clock::now())
+        {
+            auto _Deadline(::std::chrono::steady_clock::now()
+                + ::std::chrono::ceil<::std::chrono::steady_clock::duration>(_Time - _Now));
+            ::std::size_t _C(_Run_some(::std::numeric_limits<::std::size_t>::max(), _Deadline));
+            if (_C == 0u)
+            {
+                break;
+            }
+            _Count += _C;
+        }
+        return _Count;
+    }
+}
+
 // ----------------------------------------------------------------------------
 
 class stdnet::io_context
 {
+public:
+    enum class backend { libevent, poll, epoll, uring };
+
 private:
-    ::std::unique_ptr<::stdnet::_Hidden::_Context_base> _D_ownedx{new ::stdnet::_Hidden::_Poll_context()};
-    ::std::unique_ptr<::stdnet::_Hidden::_Context_base> _D_owned{new ::stdnet::_Hidden::_Libevent_context()};
+    static auto _Make_context(backend _B) -> ::std::unique_ptr<::stdnet::_Hidden::_Context_base>
+    {
+        switch (_B)
+        {
+        default:
+        case backend::libevent: return ::std::make_unique<::stdnet::_Hidden::_Libevent_context>();
+        case backend::poll:     return ::std::make_unique<::stdnet::_Hidden::_Poll_context>();
+        case backend::epoll:    return ::std::make_unique<::stdnet::_Hidden::_Epoll_context>();
+        case backend::uring:    return ::std::make_unique<::stdnet::_Hidden::_Uring_context>();
+        }
+    }
+
+    ::std::unique_ptr<::stdnet::_Hidden::_Context_base> _D_owned;
     ::stdnet::_Hidden::_Context_base&                   _D_context{*this->_D_owned};
 
 public:
     using scheduler_type = ::stdnet::_Hidden::_Io_context_scheduler;
     class executor_type {};
 
-    io_context() { std::signal(SIGPIPE, SIG_IGN); }
+    io_context(): io_context(backend::libevent) {}
+    explicit io_context(backend _B)
+        : _D_owned(_Make_context(_B))
+    {
+        std::signal(SIGPIPE, SIG_IGN);
+    }
     io_context(::stdnet::_Hidden::_Context_base& _Context): _D_owned(), _D_context(_Context) {}
     io_context(io_context&&) = delete;
 
@@ -89,16 +150,51 @@ public:
         this->_D_context._Listen(_Id, _No, _Error);
     }
     auto get_scheduler() -> scheduler_type { return scheduler_type(&this->_D_context); }
+    // set_receive_buffers() sets the number (up to 32768) and the size of the
+    // buffers used by async_receive_each(). It needs to be called before the
+    // first async_receive_each() is started.
+    auto set_receive_buffers(::std::size_t _Count, ::std::size_t _Size) -> void
+    {
+        this->_D_context._D_receive_pool._Configure(_Count, _Size);
+    }
+    // get_buffer_pool() returns the context's pool of buffers with the
+    // default size of buffer_pool (see <stdnet/buffer_pool.hpp>).
+    auto get_buffer_pool() -> ::stdnet::buffer_pool& { return this->_D_context._D_buffer_pool; }
 
-    ::std::size_t run_one() { return this->_D_context.run_one(); }
+    // The thread calling run_one() or run() owns the context: operations
+    // started from other threads are handed over to it. These functions
+    // must not be called concurrently for the same context.
+    ::std::size_t run_one()
+    {
+        this->_D_context._Set_owner();
+        return this->_D_context.run_one();
+    }
     ::std::size_t run()
     {
-        ::std::size_t _Count{};
-        while (::std::size_t _C = this->run_one())
-        {
-            _Count += _C;
-        }
-        return _Count;
+        this->_D_context._Set_owner();
+        return ::stdnet::_Hidden::_Run_all([this](::std::size_t _Max, auto _Deadline){
+            return this->_D_context._Run_some(_Max, _Deadline);
+        });
+    }
+    // run_batch() processes up to _Max completions which became ready with
+    // one readiness wait and returns how many were processed.
+    ::std::size_t run_batch(::std::size_t _Max)
+    {
+        this->_D_context._Set_owner();
+        return this->_D_context._Run_some(_Max, ::std::chrono::steady_clock::time_point::max());
+    }
+    template <typename _Rep, typename _Period>
+    ::std::size_t run_for(::std::chrono::duration<_Rep, _Period> const& _Duration)
+    {
+        return this->run_until(::std::chrono::steady_clock::now() + _Duration);
+    }
+    template <typename _Clock, typename _Duration>
+    ::std::size_t run_until(::std::chrono::time_point<_Clock, _Duration> const& _Time)
+    {
+        this->_D_context._Set_owner();
+        return ::stdnet::_Hidden::_Run_until([this](::std::size_t _Max, auto _Deadline){
+            return this->_D_context._Run_some(_Max, _Deadline);
+        }, _Time);
     }
 };
 
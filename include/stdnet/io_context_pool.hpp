@@ -0,0 +1,119 @@
+// stdnet/io_context_pool.hpp                                         -*-C++-*-
+// ----------------------------------------------------------------------------
+/*
+ * Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_STDNET_IO_CONTEXT_POOL
+#define INCLUDED_STDNET_IO_CONTEXT_POOL
+
+#include <stdnet/netfwd.hpp>
+#include <stdnet/io_context.hpp>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+// ----------------------------------------------------------------------------
+
+namespace stdnet
+{
+    class io_context_pool;
+}
+
+// ----------------------------------------------------------------------------
+// An io_context_pool holds one io_context per thread. run() runs each of the
+// contexts on its own thread which is pinned to one of the CPUs the process
+// may use. Work is distributed by creating it on the different contexts,
+// e.g., using an acceptor with reuse_port per context to have the kernel
+// balance incoming connections. Until run() is called the contexts are owned
+// by the thread creating the pool, i.e., work can be set up directly.
+
+class stdnet::io_context_pool
+{
+private:
+    ::std::vector<::std::unique_ptr<::stdnet::io_context>> _D_contexts;
+    ::std::atomic<::std::size_t>                           _D_next{};
+
+    static auto _Pin(::std::size_t _Index) -> void
+    {
+        ::cpu_set_t _Allowed;
+        CPU_ZERO(&_Allowed);
+        if (::sched_getaffinity(0, sizeof(_Allowed), &_Allowed) < 0 || CPU_COUNT(&_Allowed) == 0)
+        {
+            return;
+        }
+        _Index %= ::std::size_t(CPU_COUNT(&_Allowed));
+        for (int _Cpu{}; _Cpu != CPU_SETSIZE; ++_Cpu)
+        {
+            if (CPU_ISSET(_Cpu, &_Allowed) && _Index-- == 0u)
+            {
+                ::cpu_set_t _Set;
+                CPU_ZERO(&_Set);
+                CPU_SET(_Cpu, &_Set);
+                // pinning is only an optimization: failures are ignored
+                ::pthread_setaffinity_np(::pthread_self(), sizeof(_Set), &_Set);
+                return;
+            }
+        }
+    }
+
+public:
+    explicit io_context_pool(::std::size_t _Size = ::std::thread::hardware_concurrency(),
+                             ::stdnet::io_context::backend _Backend = ::stdnet::io_context::backend::libevent)
+    {
+        this->_D_contexts.reserve(_Size? _Size: 1u);
+        do
+        {
+            this->_D_contexts.emplace_back(::std::make_unique<::stdnet::io_context>(_Backend));
+        }
+        while (this->_D_contexts.size() < _Size);
+    }
+    io_context_pool(io_context_pool&&) = delete;
+
+    auto size() const -> ::std::size_t { return this->_D_contexts.size(); }
+    auto operator[](::std::size_t _Index) -> ::stdnet::io_context& { return *this->_D_contexts[_Index]; }
+    // get_context() returns the contexts in a round-robin fashion.
+    auto get_context() -> ::stdnet::io_context&
+    {
+        return *this->_D_contexts[this->_D_next.fetch_add(1u, ::std::memory_order_relaxed) % this->size()];
+    }
+
+    auto run() -> ::std::size_t
+    {
+        ::std::vector<::std::size_t> _Counts(this->size());
+        {
+            ::std::vector<::std::jthread> _Threads;
+            _Threads.reserve(this->size());
+            for (::std::size_t _I{}; _I != this->size(); ++_I)
+            {
+                _Threads.emplace_back([this, _I, &_Counts]{
+                    _Pin(_I);
+                    _Counts[_I] = this->_D_contexts[_I]->run();
+                });
+            }
+        }
+        return ::std::accumulate(_Counts.begin(), _Counts.end(), ::std::size_t{});
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -47,33 +47,66 @@ public:
 
     auto _Get_context() const { return this->_D_context; }
 
-    auto _Cancel(_Hidden::_Io_base* _Cancel_op, _Hidden::_Io_base* _Op) -> void
+    // Operations submitted from a thread not owning the context are posted
+    // to the context to be submitted by the thread running it.
+    template <auto _Submit, typename _Operation>
+    auto _Start(_Operation* _Op) -> bool
     {
-        this->_D_context->_Cancel(_Cancel_op, _Op);
+        if (this->_D_context->_Owned())
+        {
+            return (this->_D_context->*_Submit)(_Op);
+        }
+        this->_D_context->_Post(_Op, +[](_Hidden::_Context_base& _Context, _Hidden::_Io_base* _Base)
+            {
+                return (_Context.*_Submit)(static_cast<_Operation*>(_Base));
+            });
+        return true;
+    }
+
+    auto _Cancel(_Hidden::_Cancel_node* _Node) -> void
+    {
+        if (this->_D_context->_Owned())
+        {
+            this->_D_context->_Cancel(_Node);
+            return;
+        }
+        this->_D_context->_Post_cancel(_Node);
     }
     auto _Accept(_Hidden::_Context_base::_Accept_operation* _Op) -> bool
     {
-        return this->_D_context->_Accept(_Op);
+        return this->_Start<&_Hidden::_Context_base::_Accept>(_Op);
+    }
+    auto _Accept_multishot(_Hidden::_Context_base::_Accept_operation* _Op) -> bool
+    {
+        return this->_Start<&_Hidden::_Context_base::_Accept_multishot>(_Op);
     }
     auto _Connect(_Hidden::_Context_base::_Connect_operation* _Op) -> bool
     {
-        return this->_D_context->_Connect(_Op);
+        return this->_Start<&_Hidden::_Context_base::_Connect>(_Op);
     }
     auto _Receive(_Hidden::_Context_base::_Receive_operation* _Op) -> bool
     {
-        return this->_D_context->_Receive(_Op);
+        return this->_Start<&_Hidden::_Context_base::_Receive>(_Op);
+    }
+    auto _Receive_multishot(_Hidden::_Context_base::_Receive_multishot_operation* _Op) -> bool
+    {
+        return this->_Start<&_Hidden::_Context_base::_Receive_multishot>(_Op);
     }
     auto _Send(_Hidden::_Context_base::_Send_operation* _Op) -> bool
     {
-        return this->_D_context->_Send(_Op);
+        return this->_Start<&_Hidden::_Context_base::_Send>(_Op);
+    }
+    auto _Sendfile(_Hidden::_Context_base::_Sendfile_operation* _Op) -> bool
+    {
+        return this->_Start<&_Hidden::_Context_base::_Sendfile>(_Op);
     }
     auto _Resume_after(_Hidden::_Context_base::_Resume_after_operation* _Op) -> bool
     {
-        return this->_D_context->_Resume_after(_Op);
+        return this->_Start<&_Hidden::_Context_base::_Resume_after>(_Op);
     }
     auto _Resume_at(_Hidden::_Context_base::_Resume_at_operation* _Op) -> bool
     {
-        return this->_D_context->_Resume_at(_Op);
+        return this->_Start<&_Hidden::_Context_base::_Resume_at>(_Op);
     }
 };
 
@@ -0,0 +1,456 @@
+// stdnet/io_work.hpp                                                 -*-C++-*-
+// ----------------------------------------------------------------------------
+/*
+ * Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_STDNET_IO_WORK
+#define INCLUDED_STDNET_IO_WORK
+
+#include <stdnet/netfwd.hpp>
+#include <stdnet/context_base.hpp>
+#include <optional>
+#include <system_error>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+
+// ----------------------------------------------------------------------------
+// The functions in this header are shared by the readiness based contexts.
+// The _Try_*() functions attempt the actual work and report whether it got
+// done, failed (in which case the operation's _Error() was already called,
+// or _Cancel() if a multishot receive reached the end of the stream), or
+// would block. The _*_work() functions are used as _Work of operations
+// once the entity is ready: they return true if the operation was completed
+// (successfully or with an error) and false if the operation would block and
+// needs to wait for another readiness indication.
+
+namespace stdnet::_Hidden
+{
+    enum class _Io_result { _Done, _Failed, _Would_block };
+    struct _Speculation;
+
+    auto _Try_accept(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> ::stdnet::_Hidden::_Io_result;
+    auto _Try_receive(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> ::stdnet::_Hidden::_Io_result;
+    auto _Try_receive_multishot(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> ::stdnet::_Hidden::_Io_result;
+    auto _Try_send(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> ::stdnet::_Hidden::_Io_result;
+    auto _Try_sendfile(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> ::stdnet::_Hidden::_Io_result;
+    auto _Transferred(::stdnet::_Hidden::_Context_base::_Send_operation&, ::std::size_t) -> bool;
+
+    auto _Finish_work(::stdnet::_Hidden::_Io_result, ::stdnet::_Hidden::_Io_base*) -> bool;
+    auto _Accept_work(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> bool;
+    auto _Connect_work(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> bool;
+    auto _Receive_work(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> bool;
+    auto _Send_work(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> bool;
+    auto _Sendfile_work(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> bool;
+    auto _Timeout_work(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> bool;
+
+    template <typename _Record>
+    auto _Set_nonblocking(_Record&, ::stdnet::_Stdnet_native_handle_type, ::std::error_code&) -> void;
+    template <typename _Record>
+    auto _Set_speculative(_Record&, ::stdnet::_Stdnet_native_handle_type, void const*, ::socklen_t, ::std::error_code&) -> void;
+}
+
+// ----------------------------------------------------------------------------
+// Speculative I/O attempts receive, send, and accept operations when they are
+// submitted on sockets which opted in using socket_base::speculative_io. If
+// the operation gets done, the submit function returns false and the
+// operation is completed by the caller. To avoid unbounded recursion when
+// completions start new operations which also complete immediately, the
+// number of speculative completions between two calls to run_one() is
+// limited: once the limit is reached operations wait for readiness.
+
+struct stdnet::_Hidden::_Speculation
+{
+    static constexpr unsigned _Limit{16u};
+    unsigned _D_count{};
+
+    auto _Reset() -> void { this->_D_count = 0u; }
+    template <typename _Try>
+    auto _Attempt(bool _Enabled,
+                  ::stdnet::_Hidden::_Context_base& _Ctxt,
+                  ::stdnet::_Hidden::_Io_base* _Op,
+                  _Try _T) -> ::std::optional<bool>
+    {
+        if (!_Enabled || _Limit <= this->_D_count)
+        {
+            return {};
+        }
+        switch (_T(_Ctxt, _Op))
+        {
+        case ::stdnet::_Hidden::_Io_result::_Done:
+            ++this->_D_count;
+            return false;
+        case ::stdnet::_Hidden::_Io_result::_Failed:
+            return true;
+        case ::stdnet::_Hidden::_Io_result::_Would_block:
+            break;
+        }
+        return {};
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+template <typename _Record>
+inline auto stdnet::_Hidden::_Set_nonblocking(_Record& _R, ::stdnet::_Stdnet_native_handle_type _Handle, ::std::error_code& _Error)
+    -> void
+{
+    if (_R._Blocking)
+    {
+        int _Flags(::fcntl(_Handle, F_GETFL));
+        if (_Flags < 0 || ::fcntl(_Handle, F_SETFL, _Flags | O_NONBLOCK) < 0)
+        {
+            _Error = ::std::error_code(errno, ::std::system_category());
+            return;
+        }
+        _R._Blocking = false;
+    }
+}
+
+template <typename _Record>
+inline auto stdnet::_Hidden::_Set_speculative(_Record& _R, ::stdnet::_Stdnet_native_handle_type _Handle, void const* _Data, ::socklen_t _Size, ::std::error_code& _Error)
+    -> void
+{
+    if (_Size != sizeof(int))
+    {
+        _Error = ::std::error_code(EINVAL, ::std::system_category());
+        return;
+    }
+    bool _Value(*static_cast<int const*>(_Data));
+    if (_Value)
+    {
+        ::stdnet::_Hidden::_Set_nonblocking(_R, _Handle, _Error);
+        if (_Error)
+        {
+            return;
+        }
+    }
+    _R._Speculative = _Value;
+}
+
+// ----------------------------------------------------------------------------
+
+inline auto stdnet::_Hidden::_Try_accept(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    -> ::stdnet::_Hidden::_Io_result
+{
+    auto _Id{_Op->_Id};
+    auto& _Completion(*static_cast<::stdnet::_Hidden::_Context_base::_Accept_operation*>(_Op));
+    ::std::get<1>(_Completion) = sizeof(::std::get<0>(_Completion));
+
+    while (true)
+    {
+        int _Rc = ::accept4(_Ctxt._Native_handle(_Id),
+                            ::std::get<0>(_Completion)._Data(),
+                            &::std::get<1>(_Completion),
+                            SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (0 <= _Rc)
+        {
+            ::std::get<2>(_Completion) = _Ctxt._Make_socket(_Rc, false);
+            if (::std::get<2>(_Completion) == ::stdnet::_Hidden::_Socket_id::_Invalid)
+            {
+                _Completion._Error(::std::error_code(errno, ::std::system_category()));
+                return ::stdnet::_Hidden::_Io_result::_Failed;
+            }
+            return ::stdnet::_Hidden::_Io_result::_Done;
+        }
+        else
+        {
+            switch (errno)
+            {
+            default:
+                _Completion._Error(::std::error_code(errno, ::std::system_category()));
+                return ::stdnet::_Hidden::_Io_result::_Failed;
+            case EINTR:
+            case ECONNABORTED: // the connection was reset while queued
+                break;
+            case EWOULDBLOCK:
+                return ::stdnet::_Hidden::_Io_result::_Would_block;
+            }
+        }
+    }
+}
+
+// _Transferred() accounts for _Size bytes sent or received by a send or
+// receive operation. If fewer bytes than needed (std::get<3>()) were
+// transferred so far, the buffers are advanced past the transferred bytes
+// and true is returned: the caller transfers the remainder using the same
+// operation. A transfer of 0 bytes (end of stream) always ends it.
+
+inline auto stdnet::_Hidden::_Transferred(::stdnet::_Hidden::_Context_base::_Send_operation& _Completion,
+                                          ::std::size_t _Size) -> bool
+{
+    ::std::get<2>(_Completion) += _Size;
+    if (_Size == 0u || ::std::get<3>(_Completion) <= ::std::get<2>(_Completion))
+    {
+        return false;
+    }
+    ::msghdr& _Msg(::std::get<0>(_Completion));
+    for (; _Msg.msg_iovlen != 0u && _Msg.msg_iov->iov_len <= _Size; ++_Msg.msg_iov, --_Msg.msg_iovlen)
+    {
+        _Size -= _Msg.msg_iov->iov_len;
+    }
+    if (_Msg.msg_iovlen != 0u)
+    {
+        _Msg.msg_iov->iov_base = static_cast<char*>(_Msg.msg_iov->iov_base) + _Size;
+        _Msg.msg_iov->iov_len -= _Size;
+    }
+    return _Msg.msg_iovlen != 0u;
+}
+
+inline auto stdnet::_Hidden::_Try_receive(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    -> ::stdnet::_Hidden::_Io_result
+{
+    auto _Id{_Op->_Id};
+    auto& _Completion(*static_cast<::stdnet::_Hidden::_Context_base::_Receive_operation*>(_Op));
+
+    while (true)
+    {
+        int _Rc = ::recvmsg(_Ctxt._Native_handle(_Id),
+                            &::std::get<0>(_Completion),
+                            ::std::get<1>(_Completion));
+        if (0 <= _Rc)
+        {
+            if (::stdnet::_Hidden::_Transferred(_Completion, _Rc))
+            {
+                continue;
+            }
+            return ::stdnet::_Hidden::_Io_result::_Done;
+        }
+        else
+        {
+            switch (errno)
+            {
+            default:
+                _Completion._Error(::std::error_code(errno, ::std::system_category()));
+                return ::stdnet::_Hidden::_Io_result::_Failed;
+            case ECONNRESET:
+            case EPIPE:
+                return ::stdnet::_Hidden::_Io_result::_Done;
+            case EINTR:
+                break;
+            case EWOULDBLOCK:
+                return ::stdnet::_Hidden::_Io_result::_Would_block;
+            }
+        }
+    }
+}
+
+// A multishot receive takes a buffer from the context's pool and gives it
+// back unless data was received into it.
+
+inline auto stdnet::_Hidden::_Try_receive_multishot(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    -> ::stdnet::_Hidden::_Io_result
+{
+    auto& _Completion(*static_cast<::stdnet::_Hidden::_Context_base::_Receive_multishot_operation*>(_Op));
+    auto& _Pool(_Ctxt._D_receive_pool);
+    int   _Buffer(_Pool._Take());
+    if (_Buffer < 0)
+    {
+        _Completion._Error(::std::error_code(ENOBUFS, ::std::system_category()));
+        return ::stdnet::_Hidden::_Io_result::_Failed;
+    }
+    ::stdnet::_Hidden::_Receive_pool::_Index _Index(_Buffer);
+
+    while (true)
+    {
+        auto _Rc(::recv(_Ctxt._Native_handle(_Op->_Id), _Pool._Data(_Index), _Pool._Size(), ::std::get<0>(_Completion)));
+        if (0 < _Rc)
+        {
+            ::std::get<1>(_Completion) = _Index;
+            ::std::get<2>(_Completion) = ::std::size_t(_Rc);
+            return ::stdnet::_Hidden::_Io_result::_Done;
+        }
+        int _Errno(_Rc == 0? 0: errno);
+        if (_Errno == EINTR)
+        {
+            continue;
+        }
+        _Pool._Return(_Index);
+        switch (_Errno)
+        {
+        default:
+            _Completion._Error(::std::error_code(_Errno, ::std::system_category()));
+            return ::stdnet::_Hidden::_Io_result::_Failed;
+        case 0:
+        case ECONNRESET:
+        case EPIPE:
+            _Completion._Cancel();
+            return ::stdnet::_Hidden::_Io_result::_Failed;
+        case EWOULDBLOCK:
+            return ::stdnet::_Hidden::_Io_result::_Would_block;
+        }
+    }
+}
+
+inline auto stdnet::_Hidden::_Try_send(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    -> ::stdnet::_Hidden::_Io_result
+{
+    auto _Id{_Op->_Id};
+    auto& _Completion(*static_cast<::stdnet::_Hidden::_Context_base::_Send_operation*>(_Op));
+
+    while (true)
+    {
+        int _Rc = ::sendmsg(_Ctxt._Native_handle(_Id),
+                            &::std::get<0>(_Completion),
+                            ::std::get<1>(_Completion) | MSG_NOSIGNAL);
+        if (0 <= _Rc)
+        {
+            if (::stdnet::_Hidden::_Transferred(_Completion, _Rc))
+            {
+                continue;
+            }
+            return ::stdnet::_Hidden::_Io_result::_Done;
+        }
+        else
+        {
+            switch (errno)
+            {
+            default:
+                _Completion._Error(::std::error_code(errno, ::std::system_category()));
+                return ::stdnet::_Hidden::_Io_result::_Failed;
+            case ECONNRESET:
+            case EPIPE:
+                return ::stdnet::_Hidden::_Io_result::_Done;
+            case EINTR:
+                break;
+            case EWOULDBLOCK:
+                return ::stdnet::_Hidden::_Io_result::_Would_block;
+            }
+        }
+    }
+}
+
+// _Try_sendfile() sends until all bytes were sent, the file ended, or the
+// socket would block. The socket needs to be non-blocking: a blocking
+// sendfile() only returns once all bytes were sent.
+
+inline auto stdnet::_Hidden::_Try_sendfile(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    -> ::stdnet::_Hidden::_Io_result
+{
+    auto& _Completion(*static_cast<::stdnet::_Hidden::_Context_base::_Sendfile_operation*>(_Op));
+
+    while (::std::get<3>(_Completion) < ::std::get<2>(_Completion))
+    {
+        ::ssize_t _Rc = ::sendfile(_Ctxt._Native_handle(_Op->_Id),
+                                   ::std::get<0>(_Completion),
+                                   &::std::get<1>(_Completion),
+                                   ::std::get<2>(_Completion) - ::std::get<3>(_Completion));
+        if (0 < _Rc)
+        {
+            ::std::get<3>(_Completion) += ::std::size_t(_Rc);
+        }
+        else if (_Rc == 0)
+        {
+            break;
+        }
+        else
+        {
+            switch (errno)
+            {
+            default:
+                _Completion._Error(::std::error_code(errno, ::std::system_category()));
+                return ::stdnet::_Hidden::_Io_result::_Failed;
+            case ECONNRESET:
+            case EPIPE:
+                return ::stdnet::_Hidden::_Io_result::_Done;
+            case EINTR:
+                break;
+            case EWOULDBLOCK:
+                return ::stdnet::_Hidden::_Io_result::_Would_block;
+            }
+        }
+    }
+    return ::stdnet::_Hidden::_Io_result::_Done;
+}
+
+// ----------------------------------------------------------------------------
+
+inline auto stdnet::_Hidden::_Finish_work(::stdnet::_Hidden::_Io_result _Result, ::stdnet::_Hidden::_Io_base* _Op) -> bool
+{
+    switch (_Result)
+    {
+    case ::stdnet::_Hidden::_Io_result::_Done:
+        _Op->_Complete();
+        return true;
+    case ::stdnet::_Hidden::_Io_result::_Failed:
+        return true;
+    case ::stdnet::_Hidden::_Io_result::_Would_block:
+        break;
+    }
+    return false;
+}
+
+inline auto stdnet::_Hidden::_Accept_work(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    -> bool
+{
+    return ::stdnet::_Hidden::_Finish_work(::stdnet::_Hidden::_Try_accept(_Ctxt, _Op), _Op);
+}
+
+inline auto stdnet::_Hidden::_Connect_work(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    -> bool
+{
+    auto _Handle{_Ctxt._Native_handle(_Op->_Id)};
+
+    int _Error{};
+    ::socklen_t _Len{sizeof(_Error)};
+    if (-1 == ::getsockopt(_Handle, SOL_SOCKET, SO_ERROR, &_Error, &_Len))
+    {
+        _Op->_Error(::std::error_code(errno, ::std::system_category()));
+        return true;
+    }
+    if (0 == _Error)
+    {
+        _Op->_Complete();
+    }
+    else
+    {
+        _Op->_Error(::std::error_code(_Error, ::std::system_category()));
+    }
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Receive_work(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    -> bool
+{
+    return ::stdnet::_Hidden::_Finish_work(::stdnet::_Hidden::_Try_receive(_Ctxt, _Op), _Op);
+}
+
+inline auto stdnet::_Hidden::_Send_work(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    -> bool
+{
+    return ::stdnet::_Hidden::_Finish_work(::stdnet::_Hidden::_Try_send(_Ctxt, _Op), _Op);
+}
+
+inline auto stdnet::_Hidden::_Sendfile_work(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    -> bool
+{
+    return ::stdnet::_Hidden::_Finish_work(::stdnet::_Hidden::_Try_sendfile(_Ctxt, _Op), _Op);
+}
+
+// _Timeout_work() replaces the _Work of an operation whose deadline expired.
+
+inline auto stdnet::_Hidden::_Timeout_work(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base* _Op)
+    -> bool
+{
+    _Op->_Error(::std::make_error_code(::std::errc::timed_out));
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -23,13 +23,19 @@
 #include <stdnet/netfwd.hpp>
 #include <stdnet/container.hpp>
 #include <stdnet/context_base.hpp>
+#include <stdnet/event_fd.hpp>
+#include <stdnet/io_work.hpp>
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <new>
 #include <system_error>
+#include <utility>
 #include <cassert>
 #include <cerrno>
 #include <cstdlib>
 #include <event2/event.h>
+#include <event2/event_struct.h>
 #include <event2/util.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -41,6 +47,7 @@ namespace stdnet::_Hidden
     extern "C"
     {
         auto _Libevent_callback(int, short, void*) -> void;
+        auto _Libevent_io_callback(int, short, void*) -> void;
     }
     class _Libevent_error_category_t;
     class _Libevent_record;
@@ -73,12 +80,29 @@ inline auto stdnet::_Hidden::_Libevent_callback(int, short, void* _Arg) -> void
 }
 
 // ----------------------------------------------------------------------------
+// Each socket has a persistent read and write event which are set up when the
+// socket is created. Operations are queued on the socket and the events are
+// only added when an operation is waiting for them. They are deleted lazily
+// when they fire without a waiting operation. The events need a stable
+// address which is provided by the _Container: records are never moved.
 
 struct stdnet::_Hidden::_Libevent_record final
 {
-    _Libevent_record(::stdnet::_Stdnet_native_handle_type _H): _Handle(_H) {}
-    ::stdnet::_Stdnet_native_handle_type                   _Handle;
+    struct _Events
+    {
+        ::stdnet::_Hidden::_Libevent_context* _Context;
+        ::stdnet::_Hidden::_Socket_id         _Id;
+        ::event                               _Read;
+        ::event                               _Write;
+        ::stdnet::_Hidden::_Io_queue          _Readers;
+        ::stdnet::_Hidden::_Io_queue          _Writers;
+        bool                                  _Read_added{false};
+        bool                                  _Write_added{false};
+    };
+
     bool                                                   _Blocking{true};
+    bool                                                   _Speculative{false};
+    _Events                                                _D_events{};
 };
 
 // ----------------------------------------------------------------------------
@@ -87,10 +111,28 @@ class stdnet::_Hidden::_Libevent_context
     : public ::stdnet::_Hidden::_Context_base
 {
 private:
+    // basic_io_context<_Libevent_context> calls the functions directly.
+    template <typename> friend class ::stdnet::basic_io_context;
+    template <typename> friend class ::stdnet::_Hidden::_Static_scheduler;
+
+    friend auto ::stdnet::_Hidden::_Libevent_io_callback(int, short, void*) -> void;
+
     ::stdnet::_Hidden::_Container<::stdnet::_Hidden::_Libevent_record> _D_sockets;
     ::std::unique_ptr<::event_base, auto(*)(event_base*)->void>    _Context;
-
-    auto _Make_socket(int) -> ::stdnet::_Hidden::_Socket_id override;
+    ::std::size_t                                                  _D_pending{};
+    ::std::size_t                                                  _D_completed{};
+    ::std::size_t                                                  _D_max{};
+    ::stdnet::_Hidden::_Speculation                                _D_speculation;
+    ::stdnet::_Hidden::_Event_fd                                   _D_wakeup;
+    ::event                                                        _D_wakeup_event;
+    ::event                                                        _D_deadline_event;
+    // The events are dispatched inside event_base_loop(): while dispatching,
+    // the cached time is refreshed when the first deadline is armed. Outside
+    // of the loop arming a deadline reads the clock.
+    bool                                                           _D_dispatching{false};
+    bool                                                           _D_now_valid{false};
+
+    auto _Make_socket(int, bool) -> ::stdnet::_Hidden::_Socket_id override;
     auto _Make_socket(int, int, int, ::std::error_code&) -> ::stdnet::_Hidden::_Socket_id override;
     auto _Release(::stdnet::_Hidden::_Socket_id, ::std::error_code&) -> void override;
     auto _Native_handle(::stdnet::_Hidden::_Socket_id) -> _Stdnet_native_handle_type override;
@@ -99,37 +141,96 @@ private:
     auto _Listen(::stdnet::_Hidden::_Socket_id, int, ::std::error_code&) -> void override;
 
     auto run_one() -> ::std::size_t override;
+    auto _Run_some(::std::size_t, ::std::chrono::steady_clock::time_point) -> ::std::size_t override;
+    auto _Wakeup() -> void override;
 
-    auto _Cancel(::stdnet::_Hidden::_Io_base*, ::stdnet::_Hidden::_Io_base*) -> void override;
+    auto _Cancel(::stdnet::_Hidden::_Cancel_node*) -> void override;
     auto _Accept(::stdnet::_Hidden::_Context_base::_Accept_operation*) -> bool override;
+    auto _Accept_multishot(::stdnet::_Hidden::_Context_base::_Accept_operation*) -> bool override;
     auto _Connect(::stdnet::_Hidden::_Context_base::_Connect_operation*) -> bool override;
     auto _Receive(::stdnet::_Hidden::_Context_base::_Receive_operation*) -> bool override;
+    auto _Receive_multishot(::stdnet::_Hidden::_Context_base::_Receive_multishot_operation*) -> bool override;
     auto _Send(::stdnet::_Hidden::_Context_base::_Send_operation*) -> bool override;
+    auto _Sendfile(::stdnet::_Hidden::_Context_base::_Sendfile_operation*) -> bool override;
     auto _Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation*) -> bool override;
     auto _Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation*) -> bool override;
 
+    auto _Enqueue(::stdnet::_Hidden::_Io_base*, short) -> bool;
+    template <typename _Try>
+    auto _Submit(::stdnet::_Hidden::_Io_base*, short, _Try) -> bool;
+    auto _Dispatch(::stdnet::_Hidden::_Libevent_record::_Events&, short) -> void;
+    template <auto _Try>
+    static auto _Multishot_work(::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base*) -> bool;
+    auto _Add_timer(::stdnet::_Hidden::_Io_base*, _Timer_storage&, ::std::chrono::microseconds) -> bool;
+    auto _Arm_deadline(::stdnet::_Hidden::_Io_base*) -> void;
+    auto _Disarm_deadline(::stdnet::_Hidden::_Io_base*) -> void;
+    auto _Expired(::stdnet::_Hidden::_Io_base*) -> void;
+
+    auto _Initialize() -> void;
+    auto _Completed() -> void;
+
 public:
     _Libevent_context();
     _Libevent_context(::event_base*);
+    _Libevent_context(_Libevent_context&&) = delete;
+    ~_Libevent_context();
 };
 
 // ----------------------------------------------------------------------------
 
+inline auto stdnet::_Hidden::_Libevent_io_callback(int, short _What, void* _Arg) -> void
+{
+    auto& _Events(*static_cast<::stdnet::_Hidden::_Libevent_record::_Events*>(_Arg));
+    _Events._Context->_Dispatch(_Events, _What);
+}
+
+// ----------------------------------------------------------------------------
+
 inline stdnet::_Hidden::_Libevent_context::_Libevent_context()
     : _Context(::event_base_new(), +[](::event_base* _C){ ::event_base_free(_C); })
 {
+    this->_Initialize();
 }
 
 inline stdnet::_Hidden::_Libevent_context::_Libevent_context(::event_base* _C)
     : _Context(_C, +[](::event_base*){})
 {
+    this->_Initialize();
+}
+
+inline stdnet::_Hidden::_Libevent_context::~_Libevent_context()
+{
+    ::event_del(&this->_D_wakeup_event);
+    ::event_del(&this->_D_deadline_event);
+}
+
+inline auto stdnet::_Hidden::_Libevent_context::_Initialize() -> void
+{
+    ::event_assign(&this->_D_wakeup_event, this->_Context.get(), this->_D_wakeup._Native_handle(), EV_READ | EV_PERSIST,
+                   +[](int, short, void* _Arg){ static_cast<::stdnet::_Hidden::_Event_fd*>(_Arg)->_Drain(); },
+                   &this->_D_wakeup);
+    ::event_add(&this->_D_wakeup_event, nullptr);
+    // The deadline timer only needs to make the loop return.
+    ::evtimer_assign(&this->_D_deadline_event, this->_Context.get(), +[](int, short, void*){}, nullptr);
+}
+
+inline auto stdnet::_Hidden::_Libevent_context::_Wakeup() -> void
+{
+    this->_D_wakeup._Signal();
 }
 
 // ----------------------------------------------------------------------------
 
-inline auto stdnet::_Hidden::_Libevent_context::_Make_socket(int _Fd) -> ::stdnet::_Hidden::_Socket_id
+inline auto stdnet::_Hidden::_Libevent_context::_Make_socket(int _Fd, bool _Blocking) -> ::stdnet::_Hidden::_Socket_id
 {
-    return this->_D_sockets._Insert(_Fd);
+    auto _Id(this->_D_sockets._Insert(_Fd));
+    this->_D_sockets[_Id]._Blocking = _Blocking;
+    auto& _Events(this->_D_sockets[_Id]._D_events);
+    _Events._Context = this;
+    _Events._Id      = _Id;
+    ::event_assign(&_Events._Read, this->_Context.get(), _Fd, EV_READ | EV_PERSIST, _Libevent_io_callback, &_Events);
+    ::event_assign(&_Events._Write, this->_Context.get(), _Fd, EV_WRITE | EV_PERSIST, _Libevent_io_callback, &_Events);
+    return _Id;
 }
 
 inline auto stdnet::_Hidden::_Libevent_context::_Make_socket(int _D, int _T, int _P, ::std::error_code& _Error)
@@ -141,22 +242,44 @@ inline auto stdnet::_Hidden::_Libevent_context::_Make_socket(int _D, int _T, int
         _Error = ::std::error_code(errno, ::std::system_category());
         return ::stdnet::_Hidden::_Socket_id::_Invalid;
     }
-    return this->_Make_socket(_Fd);
+    return this->_Make_socket(_Fd, true);
 }
 
 inline auto stdnet::_Hidden::_Libevent_context::_Release(::stdnet::_Hidden::_Socket_id _Id, ::std::error_code& _Error) -> void
 {
-    _Stdnet_native_handle_type _Handle(this->_D_sockets[_Id]._Handle);
+    if (!this->_D_sockets._Valid(_Id))
+    {
+        _Error = ::std::error_code(EBADF, ::std::system_category());
+        return;
+    }
+    auto& _Events(this->_D_sockets[_Id]._D_events);
+    _Stdnet_native_handle_type _Handle(this->_D_sockets._Handle(_Id));
+    ::event_del(&_Events._Read);
+    ::event_del(&_Events._Write);
+    ::stdnet::_Hidden::_Io_queue _Pending;
+    for (auto* _Queue: { &_Events._Readers, &_Events._Writers })
+    {
+        while (::stdnet::_Hidden::_Io_base* _Op = _Queue->_Pop())
+        {
+            --this->_D_pending;
+            this->_Disarm_deadline(_Op);
+            _Pending._Push(_Op);
+        }
+    }
     this->_D_sockets._Erase(_Id);
     if (::close(_Handle) < 0)
     {
         _Error = ::std::error_code(errno, ::std::system_category());
     }
+    while (::stdnet::_Hidden::_Io_base* _Op = _Pending._Pop())
+    {
+        _Op->_Cancel();
+    }
 }
 
 inline auto stdnet::_Hidden::_Libevent_context::_Native_handle(::stdnet::_Hidden::_Socket_id _Id) -> _Stdnet_native_handle_type
 {
-    return this->_D_sockets[_Id]._Handle;
+    return this->_D_sockets._Handle(_Id);
 }
 
 inline auto stdnet::_Hidden::_Libevent_context::_Set_option(::stdnet::_Hidden::_Socket_id _Id,
@@ -167,6 +290,11 @@ inline auto stdnet::_Hidden::_Libevent_context::_Set_option(::stdnet::_Hidden::_
                                                          ::std::error_code&            _Error)
     -> void
 {
+    if (_Level == ::stdnet::_Hidden::_Stdnet_option_level && _Name == ::stdnet::_Hidden::_Speculative_io_option)
+    {
+        ::stdnet::_Hidden::_Set_speculative(this->_D_sockets[_Id], this->_D_sockets._Handle(_Id), _Data, _Size, _Error);
+        return;
+    }
     if (::setsockopt(this->_Native_handle(_Id), _Level, _Name, _Data, _Size) < 0)
     {
         _Error = ::std::error_code(errno, ::std::system_category());
@@ -192,317 +320,393 @@ inline auto stdnet::_Hidden::_Libevent_context::_Listen(::stdnet::_Hidden::_Sock
     if (::listen(this->_Native_handle(_Id), _No) < 0)
     {
         _Error = ::std::error_code(errno, ::std::system_category());
+        return;
     }
+    // A non-blocking listener allows draining the backlog (see _Dispatch()).
+    ::stdnet::_Hidden::_Set_nonblocking(this->_D_sockets[_Id], this->_D_sockets._Handle(_Id), _Error);
 }
 
 inline auto stdnet::_Hidden::_Libevent_context::run_one() -> ::std::size_t
 {
-    // event_base_loop(..., EVLOOP_ONCE) may process multiple events but
-    // it doesn't say how many. As a result, the return from run_one() may
-    // be incorrect.
-    return 0 == event_base_loop(this->_Context.get(), EVLOOP_ONCE)? 1u: 0;
+    return this->_Run_some(1u, ::std::chrono::steady_clock::time_point::max());
 }
 
-inline auto stdnet::_Hidden::_Libevent_context::_Cancel(::stdnet::_Hidden::_Io_base* _Cancel_op,
-                                                     ::stdnet::_Hidden::_Io_base* _Op) -> void
+// event_base_loop(..., EVLOOP_ONCE) processes all active events. The
+// completions are counted by _Completed() which breaks out of the loop once
+// _D_max completions are reached: the remaining active events are processed
+// by the next loop. The persistent socket events may stay added without a
+// waiting operation, i.e., the loop is only entered if there is work.
+
+inline auto stdnet::_Hidden::_Libevent_context::_Run_some(::std::size_t _Max,
+                                                       ::std::chrono::steady_clock::time_point _Deadline)
+    -> ::std::size_t
 {
-    if (_Op->_Extra && -1 == event_del(static_cast<::event *>(_Op->_Extra.get())))
+    this->_D_speculation._Reset();
+    ::std::size_t _Count(this->_Run_posted());
+    bool          _Waited{false};
+    while (true)
     {
-        assert("deleting a libevent event failed!" == nullptr);
+        if (_Count != 0u || this->_D_pending == 0u)
+        {
+            return _Count;
+        }
+        bool _Limited(_Deadline != ::std::chrono::steady_clock::time_point::max());
+        if (_Limited)
+        {
+            auto _Now(::std::chrono::steady_clock::now());
+            if (_Waited && _Deadline <= _Now)
+            {
+                return ::std::size_t{};
+            }
+            auto _Timeout(::std::chrono::ceil<::std::chrono::microseconds>(::std::max(_Deadline - _Now, ::std::chrono::steady_clock::duration{})));
+            ::timeval _Tv{};
+            _Tv.tv_sec  = _Timeout.count() / 1'000'000;
+            _Tv.tv_usec = _Timeout.count() % 1'000'000;
+            ::evtimer_add(&this->_D_deadline_event, &_Tv);
+        }
+
+        this->_D_completed = 0u;
+        this->_D_max       = _Max;
+        this->_D_dispatching = true;
+        this->_D_now_valid   = false;
+        int _Rc(::event_base_loop(this->_Context.get(), EVLOOP_ONCE));
+        this->_D_dispatching = false;
+        _Count = ::std::exchange(this->_D_completed, 0u);
+        if (_Limited)
+        {
+            ::event_del(&this->_D_deadline_event);
+        }
+        if (_Rc < 0)
+        {
+            return _Count;
+        }
+        _Waited = true;
+        _Count += this->_Run_posted();
     }
-    _Cancel_op->_Cancel();
-    _Op->_Cancel();
 }
 
-inline auto stdnet::_Hidden::_Libevent_context::_Accept(::stdnet::_Hidden::_Context_base::_Accept_operation* _Op) -> bool
+inline auto stdnet::_Hidden::_Libevent_context::_Completed() -> void
 {
-    auto _Handle(this->_Native_handle(_Op->_Id));
-    ::event* _Ev(::event_new(this->_Context.get(), _Handle, EV_READ, _Libevent_callback, _Op));
-    if (_Ev == nullptr)
+    if (++this->_D_completed == this->_D_max)
     {
-        _Op->_Error(::std::error_code(evutil_socket_geterror(_Handle), stdnet::_Hidden::_Libevent_error_category()));
-        return false;
+        ::event_base_loopbreak(this->_Context.get());
     }
-    _Op->_Context = this;
-    _Op->_Extra = std::unique_ptr<void, auto(*)(void*)->void>(
-        _Ev,
-        +[](void* _Ev){ ::event_free(static_cast<::event*>(_Ev)); });
+}
 
-    _Op->_Work =
-        [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+// ----------------------------------------------------------------------------
+// _Dispatch() is called when a socket event fired: the first waiting
+// operation is processed. Once the operation completed the socket may be
+// gone: the events are only touched again if the id is still valid. For a
+// non-blocking socket further waiting readers are processed until one would
+// block, e.g., a burst of connections is accepted with one event.
+
+inline auto stdnet::_Hidden::_Libevent_context::_Dispatch(::stdnet::_Hidden::_Libevent_record::_Events& _Events,
+                                                       short _What) -> void
+{
+    bool _Read(_What & EV_READ);
+    auto& _Queue(_Read? _Events._Readers: _Events._Writers);
+    if (_Queue._Empty())
+    {
+        ::event_del(_Read? &_Events._Read: &_Events._Write);
+        (_Read? _Events._Read_added: _Events._Write_added) = false;
+        return;
+    }
+    auto _Id(_Events._Id);
+    do
+    {
+        ::stdnet::_Hidden::_Io_base* _Op(_Queue._Pop());
+        this->_Disarm_deadline(_Op);
+        if (!_Op->_Work(*this, _Op))
         {
-            auto _Id{_Op->_Id};
-            auto& _Completion(*static_cast<_Accept_operation*>(_Op));
-
-            while (true)
-            {
-                int _Rc = ::accept(_Ctxt._Native_handle(_Id), ::std::get<0>(_Completion)._Data(), &::std::get<1>(_Completion));
-                if (0 <= _Rc)
-                {
-                    ::std::get<2>(_Completion) = _Ctxt._Make_socket(_Rc);
-                    _Completion._Complete();
-                    return true;
-                }
-                else
-                {
-                    switch (errno)
-                    {
-                    default:
-                        _Completion._Error(::std::error_code(errno, ::std::system_category()));
-                        return true;
-                    case EINTR:
-                        break;
-                    case EWOULDBLOCK:
-                        return false;
-                    }
-                }
-            }
-        };
+            _Queue._Push_front(_Op);
+            this->_Arm_deadline(_Op);
+            return;
+        }
+        --this->_D_pending;
+        this->_Completed();
+    }
+    while (_Read
+           && this->_D_completed < this->_D_max
+           && this->_D_sockets._Valid(_Id)
+           && !this->_D_sockets[_Id]._Blocking
+           && !_Queue._Empty());
+}
 
-    ::event_add(_Ev, nullptr);
+inline auto stdnet::_Hidden::_Libevent_context::_Enqueue(::stdnet::_Hidden::_Io_base* _Op, short _What) -> bool
+{
+    auto& _Events(this->_D_sockets[_Op->_Id]._D_events);
+    bool _Read(_What == EV_READ);
+    bool& _Added(_Read? _Events._Read_added: _Events._Write_added);
+    if (!_Added)
+    {
+        if (::event_add(_Read? &_Events._Read: &_Events._Write, nullptr) < 0)
+        {
+            _Op->_Error(::std::error_code(evutil_socket_geterror(_Events._Id), stdnet::_Hidden::_Libevent_error_category()));
+            return true;
+        }
+        _Added = true;
+    }
+    _Op->_Context = this;
+    _Op->_Event   = _What;
+    ++this->_D_pending;
+    (_Read? _Events._Readers: _Events._Writers)._Push(_Op);
+    this->_Arm_deadline(_Op);
     return true;
 }
-// ----------------------------------------------------------------------------
 
-inline auto stdnet::_Hidden::_Libevent_context::_Connect(::stdnet::_Hidden::_Context_base::_Connect_operation* _Op) -> bool
+// Socket operations with a deadline use a timer event in their deadline
+// storage while they are waiting. When the timer fires first, the operation
+// is removed from its queue and completes with a timeout. The timer is
+// removed before the operation is processed as the operation's completion
+// may destroy the storage.
+
+inline auto stdnet::_Hidden::_Libevent_context::_Arm_deadline(::stdnet::_Hidden::_Io_base* _Op) -> void
 {
-    auto _Handle(this->_Native_handle(_Op->_Id));
-    auto const& _Endpoint(::std::get<0>(*_Op));
-    if (-1 == ::fcntl(_Handle, F_SETFL, O_NONBLOCK))
+    if (_Op->_Deadline)
     {
-        _Op->_Error(::std::error_code(errno, ::std::system_category()));
-        return false;
+        ::event* _Ev(reinterpret_cast<::event*>(_Op->_Deadline->_Storage._Data));
+        ::evtimer_assign(_Ev, this->_Context.get(),
+                         +[](int, short, void* _Arg){
+                             auto _Op(static_cast<::stdnet::_Hidden::_Io_base*>(_Arg));
+                             static_cast<_Libevent_context*>(_Op->_Context)->_Expired(_Op);
+                         },
+                         _Op);
+        if (!this->_D_now_valid)
+        {
+            this->_Update_now();
+            this->_D_now_valid = this->_D_dispatching;
+        }
+        auto _Time(_Op->_Deadline->_Resolve(this->_Now()));
+        auto _Timeout(::std::chrono::ceil<::std::chrono::microseconds>(
+            ::std::max(_Time - this->_Now(), ::std::chrono::steady_clock::duration{})));
+        ::timeval _Tv{};
+        _Tv.tv_sec  = _Timeout.count() / 1'000'000;
+        _Tv.tv_usec = _Timeout.count() % 1'000'000;
+        ::evtimer_add(_Ev, &_Tv);
     }
-    if (0 == ::connect(_Handle, _Endpoint._Data(), _Endpoint._Size()))
+}
+
+inline auto stdnet::_Hidden::_Libevent_context::_Disarm_deadline(::stdnet::_Hidden::_Io_base* _Op) -> void
+{
+    if (_Op->_Deadline)
     {
-        _Op->_Complete();
-        return false;
+        ::event_del(::std::launder(reinterpret_cast<::event*>(_Op->_Deadline->_Storage._Data)));
     }
-    switch (errno)
+}
+
+inline auto stdnet::_Hidden::_Libevent_context::_Expired(::stdnet::_Hidden::_Io_base* _Op) -> void
+{
+    auto& _Events(this->_D_sockets[_Op->_Id]._D_events);
+    (_Op->_Event == EV_READ? _Events._Readers: _Events._Writers)._Erase(_Op);
+    --this->_D_pending;
+    this->_Completed();
+    ::stdnet::_Hidden::_Timeout_work(*this, _Op);
+}
+
+// _Submit() tries the operation right away if speculative I/O is enabled for
+// the socket and no other operation is waiting in the same direction.
+
+template <typename _Try>
+inline auto stdnet::_Hidden::_Libevent_context::_Submit(::stdnet::_Hidden::_Io_base* _Op, short _What, _Try _T) -> bool
+{
+    auto& _Record(this->_D_sockets[_Op->_Id]);
+    bool _Idle((_What == EV_READ? _Record._D_events._Readers: _Record._D_events._Writers)._Empty());
+    if (auto _Rc = this->_D_speculation._Attempt(_Record._Speculative && _Idle, *this, _Op, _T))
     {
-    default:
-        _Op->_Error(::std::error_code(errno, ::std::system_category()));
-        return false;
-    case EINPROGRESS:
-    case EINTR:
-        break;
+        return *_Rc;
     }
+    return this->_Enqueue(_Op, _What);
+}
 
-    ::event* _Ev(::event_new(this->_Context.get(), _Handle, EV_READ | EV_WRITE, _Libevent_callback, _Op));
-    if (_Ev == nullptr)
+inline auto stdnet::_Hidden::_Libevent_context::_Add_timer(::stdnet::_Hidden::_Io_base* _Op,
+                                                        _Timer_storage& _Storage,
+                                                        ::std::chrono::microseconds _Duration) -> bool
+{
+    static_assert(sizeof(::event) <= sizeof(_Timer_storage));
+    assert(::event_get_struct_event_size() <= sizeof(_Timer_storage));
+
+    ::event* _Ev(reinterpret_cast<::event*>(_Storage._Data));
+    if (::evtimer_assign(_Ev, this->_Context.get(), _Libevent_callback, _Op) < 0)
     {
-        _Op->_Error(::std::error_code(evutil_socket_geterror(_Handle), stdnet::_Hidden::_Libevent_error_category()));
-        return false;
+        _Op->_Error(::std::error_code(evutil_socket_geterror(-1), stdnet::_Hidden::_Libevent_error_category()));
+        return true;
     }
     _Op->_Context = this;
-    _Op->_Extra = std::unique_ptr<void, auto(*)(void*)->void>(
-        _Ev,
-        +[](void* _Ev){ ::event_free(static_cast<::event*>(_Ev)); });
-
-    _Op->_Work =
-        [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    _Op->_Event   = 0;
+    _Op->_Extra   = ::stdnet::_Hidden::_Io_base::_Extra_t(_Ev, +[](void*){});
+    _Op->_Work    = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
         {
-            auto _Handle{_Ctxt._Native_handle(_Op->_Id)};
-            auto& _Completion(*static_cast<_Connect_operation*>(_Op));
-
-            int _Error{};
-            ::socklen_t _Len{sizeof(_Error)};
-            if (-1 == ::getsockopt(_Handle, SOL_SOCKET, SO_ERROR, &_Error, &_Len))
-            {
-                _Op->_Error(::std::error_code(errno, ::std::system_category()));
-                return true;
-            }
-            if (0 == _Error)
-            {
-                _Op->_Complete();
-            }
-            else
-            {
-                _Op->_Error(::std::error_code(_Error, ::std::system_category()));
-            }
+            auto& _Context(static_cast<_Libevent_context&>(_Ctxt));
+            --_Context._D_pending;
+            _Context._Completed();
+            _Op->_Complete();
             return true;
         };
 
-    ::event_add(_Ev, nullptr);
+    constexpr long long _F(1'000'000);
+    ::timeval _Tv{};
+    _Tv.tv_sec  = _Duration.count() / _F;
+    _Tv.tv_usec = _Duration.count() % _F;
+    ::evtimer_add(_Ev, &_Tv);
+    ++this->_D_pending;
     return true;
-} 
+}
 
 // ----------------------------------------------------------------------------
 
-inline auto stdnet::_Hidden::_Libevent_context::_Receive(::stdnet::_Hidden::_Context_base::_Receive_operation* _Op) -> bool
+inline auto stdnet::_Hidden::_Libevent_context::_Cancel(::stdnet::_Hidden::_Cancel_node* _Node) -> void
 {
-    auto _Handle(this->_Native_handle(_Op->_Id));
-    ::event* _Ev(::event_new(this->_Context.get(), _Handle, EV_READ, _Libevent_callback, _Op));
-    if (_Ev == nullptr)
+    ::stdnet::_Hidden::_Io_base* _Op(_Node->_Op);
+    // The operation may have completed already (and its socket may have been
+    // released) if the cancellation was posted from another thread.
+    bool _Found{false};
+    if (_Op->_Event == 0)
     {
-        _Op->_Error(::std::error_code(evutil_socket_geterror(_Handle), stdnet::_Hidden::_Libevent_error_category()));
-        return false;
+        ::event* _Ev(static_cast<::event*>(_Op->_Extra.get()));
+        _Found = ::event_pending(_Ev, EV_TIMEOUT, nullptr);
+        if (_Found && -1 == event_del(_Ev))
+        {
+            assert("deleting a libevent event failed!" == nullptr);
+        }
     }
-    _Op->_Context = this;
-    _Op->_Extra = std::unique_ptr<void, auto(*)(void*)->void>(
-        _Ev,
-        +[](void* _Ev){ ::event_free(static_cast<::event*>(_Ev)); });
-
-    _Op->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+    else if (this->_D_sockets._Valid(_Op->_Id))
+    {
+        auto& _Events(this->_D_sockets[_Op->_Id]._D_events);
+        _Found = (_Op->_Event == EV_READ? _Events._Readers: _Events._Writers)._Erase(_Op);
+        if (_Found)
         {
-            auto _Id{_Op->_Id};
-            auto& _Completion(*static_cast<_Receive_operation*>(_Op));
+            this->_Disarm_deadline(_Op);
+        }
+    }
+    _Node->_Done(_Node);
+    if (_Found)
+    {
+        --this->_D_pending;
+        _Op->_Cancel();
+    }
+}
 
-            while (true)
-            {
-                int _Rc = ::recvmsg(_Ctxt._Native_handle(_Id),
-                                    &::std::get<0>(_Completion),
-                                    ::std::get<1>(_Completion));
-                if (0 <= _Rc)
-                {
-                    ::std::get<2>(_Completion) = _Rc;
-                    _Completion._Complete();
-                    return true;
-                }
-                else
-                {
-                    switch (errno)
-                    {
-                    default:
-                        _Completion._Error(::std::error_code(errno, ::std::system_category()));
-                        return true;
-                    case ECONNRESET:
-                    case EPIPE:
-                        ::std::get<2>(_Completion) = 0u;
-                        _Completion._Complete();
-                        return true;
-                    case EINTR:
-                        break;
-                    case EWOULDBLOCK:
-                        return false;
-                    }
-                }
-            }
-        };
+inline auto stdnet::_Hidden::_Libevent_context::_Accept(::stdnet::_Hidden::_Context_base::_Accept_operation* _Op) -> bool
+{
+    _Op->_Work = ::stdnet::_Hidden::_Accept_work;
+    return this->_Submit(_Op, EV_READ, ::stdnet::_Hidden::_Try_accept);
+}
+
+
+// A multishot operation is queued again before each completion: the
+// completion may release the socket or cancel the operation. _Dispatch()
+// repeats the operation until it would block.
 
-    ::event_add(_Ev, nullptr);
+template <auto _Try>
+inline auto stdnet::_Hidden::_Libevent_context::_Multishot_work(::stdnet::_Hidden::_Context_base& _Ctxt,
+                                                                ::stdnet::_Hidden::_Io_base* _Op)
+    -> bool
+{
+    auto _Result(_Try(_Ctxt, _Op));
+    if (_Result != ::stdnet::_Hidden::_Io_result::_Done)
+    {
+        return _Result == ::stdnet::_Hidden::_Io_result::_Failed;
+    }
+    auto& _Context(static_cast<::stdnet::_Hidden::_Libevent_context&>(_Ctxt));
+    ++_Context._D_pending;
+    _Context._D_sockets[_Op->_Id]._D_events._Readers._Push(_Op);
+    _Op->_Complete();
     return true;
 }
 
-inline auto stdnet::_Hidden::_Libevent_context::_Send(::stdnet::_Hidden::_Context_base::_Send_operation* _Op) -> bool 
+inline auto stdnet::_Hidden::_Libevent_context::_Accept_multishot(::stdnet::_Hidden::_Context_base::_Accept_operation* _Op) -> bool
+{
+    _Op->_Work = _Multishot_work<::stdnet::_Hidden::_Try_accept>;
+    return this->_Enqueue(_Op, EV_READ);
+}
+
+// ----------------------------------------------------------------------------
+
+inline auto stdnet::_Hidden::_Libevent_context::_Connect(::stdnet::_Hidden::_Context_base::_Connect_operation* _Op) -> bool
 {
     auto _Handle(this->_Native_handle(_Op->_Id));
-    ::event* _Ev(::event_new(this->_Context.get(), _Handle, EV_WRITE, _Libevent_callback, _Op));
-    if (_Ev == nullptr)
+    auto const& _Endpoint(::std::get<0>(*_Op));
+    if (-1 == ::fcntl(_Handle, F_SETFL, O_NONBLOCK))
+    {
+        _Op->_Error(::std::error_code(errno, ::std::system_category()));
+        return true;
+    }
+    if (0 == ::connect(_Handle, _Endpoint._Data(), _Endpoint._Size()))
     {
-        _Op->_Error(::std::error_code(evutil_socket_geterror(_Handle), stdnet::_Hidden::_Libevent_error_category()));
         return false;
     }
-    _Op->_Context = this;
-    _Op->_Extra = std::unique_ptr<void, auto(*)(void*)->void>(
-        _Ev,
-        +[](void* _Ev){ ::event_free(static_cast<::event*>(_Ev)); });
+    switch (errno)
+    {
+    default:
+        _Op->_Error(::std::error_code(errno, ::std::system_category()));
+        return true;
+    case EINPROGRESS:
+    case EINTR:
+        break;
+    }
 
-    _Op->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
-        {
-            auto _Id{_Op->_Id};
-            auto& _Completion(*static_cast<_Receive_operation*>(_Op));
+    _Op->_Work = ::stdnet::_Hidden::_Connect_work;
+    return this->_Enqueue(_Op, EV_WRITE);
+}
 
-            while (true)
-            {
-                int _Rc = ::sendmsg(_Ctxt._Native_handle(_Id),
-                                    &::std::get<0>(_Completion),
-                                    ::std::get<1>(_Completion));
-                if (0 <= _Rc)
-                {
-                    ::std::get<2>(_Completion) = _Rc;
-                    _Completion._Complete();
-                    return true;
-                }
-                else
-                {
-                    switch (errno)
-                    {
-                    default:
-                        _Completion._Error(::std::error_code(errno, ::std::system_category()));
-                        return true;
-                    case ECONNRESET:
-                    case EPIPE:
-                        ::std::get<2>(_Completion) = 0u;
-                        _Completion._Complete();
-                        return true;
-                    case EINTR:
-                        break;
-                    case EWOULDBLOCK:
-                        return false;
-                    }
-                }
-            }
-        };
+// ----------------------------------------------------------------------------
 
-    ::event_add(_Ev, nullptr);
-    return true;
+inline auto stdnet::_Hidden::_Libevent_context::_Receive(::stdnet::_Hidden::_Context_base::_Receive_operation* _Op) -> bool
+{
+    _Op->_Work = ::stdnet::_Hidden::_Receive_work;
+    return this->_Submit(_Op, EV_READ, ::stdnet::_Hidden::_Try_receive);
 }
 
-auto ::stdnet::_Hidden::_Libevent_context::_Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation* _Op) -> bool
+// The socket is made non-blocking such that _Dispatch() can repeat the
+// multishot receive until it would block.
+
+inline auto stdnet::_Hidden::_Libevent_context::_Receive_multishot(::stdnet::_Hidden::_Context_base::_Receive_multishot_operation* _Op) -> bool
 {
-    ::event* _Ev(evtimer_new(this->_Context.get(), _Libevent_callback, _Op));
-    if (_Ev == nullptr)
+    ::std::error_code _Error;
+    ::stdnet::_Hidden::_Set_nonblocking(this->_D_sockets[_Op->_Id], this->_D_sockets._Handle(_Op->_Id), _Error);
+    if (_Error)
     {
-        _Op->_Error(::std::error_code(evutil_socket_geterror(_Handle), stdnet::_Hidden::_Libevent_error_category()));
-        return false;
+        _Op->_Error(_Error);
+        return true;
     }
-    _Op->_Context = this;
-    _Op->_Extra = std::unique_ptr<void, auto(*)(void*)->void>(
-        _Ev,
-        +[](void* _Ev){ ::event_free(static_cast<::event*>(_Ev)); });
+    _Op->_Work = _Multishot_work<::stdnet::_Hidden::_Try_receive_multishot>;
+    return this->_Enqueue(_Op, EV_READ);
+}
 
-    _Op->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
-        {
-            auto& _Completion(*static_cast<_Resume_after_operation*>(_Op));
-            _Completion._Complete();
-            return true;
-        };
-    
-    constexpr unsigned long long _F(1'000'000);
-    ::std::chrono::microseconds _Duration(::std::get<0>(*_Op));
-    ::timeval& _Tv(::std::get<1>(*_Op));
-    _Tv.tv_sec = _Duration.count() / _F;
-    _Tv.tv_usec = 1000 * _Duration.count() % _F;
-    ::evtimer_add(_Ev, &_Tv);
-    return true;
+inline auto stdnet::_Hidden::_Libevent_context::_Send(::stdnet::_Hidden::_Context_base::_Send_operation* _Op) -> bool 
+{
+    _Op->_Work = ::stdnet::_Hidden::_Send_work;
+    return this->_Submit(_Op, EV_WRITE, ::stdnet::_Hidden::_Try_send);
 }
 
-auto ::stdnet::_Hidden::_Libevent_context::_Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation* _Op) -> bool
+inline auto stdnet::_Hidden::_Libevent_context::_Sendfile(::stdnet::_Hidden::_Context_base::_Sendfile_operation* _Op) -> bool
 {
-    auto _Now(::std::chrono::system_clock::now());
-    auto _Time(::std::get<0>(*_Op));
-    if (_Time <= _Now)
+    ::std::error_code _Error;
+    ::stdnet::_Hidden::_Set_nonblocking(this->_D_sockets[_Op->_Id], this->_D_sockets._Handle(_Op->_Id), _Error);
+    if (_Error)
     {
-        _Op->_Complete();
-        return false;
+        _Op->_Error(_Error);
+        return true;
     }
+    _Op->_Work = ::stdnet::_Hidden::_Sendfile_work;
+    return this->_Submit(_Op, EV_WRITE, ::stdnet::_Hidden::_Try_sendfile);
+}
+
+inline auto stdnet::_Hidden::_Libevent_context::_Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation* _Op) -> bool
+{
+    return this->_Add_timer(_Op, ::std::get<1>(*_Op), ::std::chrono::ceil<::std::chrono::microseconds>(::std::get<0>(*_Op)));
+}
 
-    ::event* _Ev(evtimer_new(this->_Context.get(), _Libevent_callback, _Op));
-    if (_Ev == nullptr)
+inline auto stdnet::_Hidden::_Libevent_context::_Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation* _Op) -> bool
+{
+    // libevent timers are relative with microsecond resolution.
+    auto _Now(::std::chrono::steady_clock::now());
+    auto _Time(::std::get<0>(*_Op));
+    if (_Time <= _Now)
     {
-        _Op->_Error(::std::error_code(evutil_socket_geterror(_Handle), stdnet::_Hidden::_Libevent_error_category()));
         return false;
     }
-    _Op->_Context = this;
-    _Op->_Extra = std::unique_ptr<void, auto(*)(void*)->void>(
-        _Ev,
-        +[](void* _Ev){ ::event_free(static_cast<::event*>(_Ev)); });
-
-    _Op->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
-        {
-            auto& _Completion(*static_cast<_Resume_after_operation*>(_Op));
-            _Completion._Complete();
-            return true;
-        };
-    
-    constexpr unsigned long long _F(1'000'000);
-    auto _Duration(::std::chrono::duration_cast<::std::chrono::microseconds>(_Time - _Now));
-    ::timeval& _Tv(::std::get<1>(*_Op));
-    _Tv.tv_sec = _Duration.count() / _F;
-    _Tv.tv_usec = 1000 * _Duration.count() % _F;
-    ::evtimer_add(_Ev, &_Tv);
-    return true;
+    return this->_Add_timer(_Op, ::std::get<1>(*_Op), ::std::chrono::ceil<::std::chrono::microseconds>(_Time - _Now));
 }
 
 // ----------------------------------------------------------------------------
@@ -38,16 +38,24 @@ namespace stdnet
     namespace _Hidden
     {
         class _Context_base;
+        class _Io_context_scheduler;
+        template <typename> class _Static_scheduler;
+
+        // Options handled by the contexts rather than the kernel use a
+        // level which isn't used by any protocol.
+        inline constexpr int _Stdnet_option_level{-1};
+        inline constexpr int _Speculative_io_option{1};
     }
     using _Stdnet_native_handle_type = int;
     inline constexpr _Stdnet_native_handle_type _Stdnet_invalid_handle{-1};
 
 
     class io_context;
+    template <typename> class basic_io_context;
     class socket_base;
-    template <typename> class basic_socket;
-    template <typename> class basic_stream_socket;
-    template <typename> class basic_socket_acceptor;
+    template <typename, typename = ::stdnet::_Hidden::_Io_context_scheduler> class basic_socket;
+    template <typename, typename = ::stdnet::_Hidden::_Io_context_scheduler> class basic_stream_socket;
+    template <typename, typename = ::stdnet::io_context> class basic_socket_acceptor;
     namespace ip
     {
         template <typename> class basic_endpoint;
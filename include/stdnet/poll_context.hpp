@@ -23,7 +23,17 @@
 #include <stdnet/netfwd.hpp>
 #include <stdnet/container.hpp>
 #include <stdnet/context_base.hpp>
+#include <stdnet/event_fd.hpp>
+#include <stdnet/io_work.hpp>
+#include <stdnet/timer_wheel.hpp>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <new>
+#include <utility>
 #include <vector>
+#include <cerrno>
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <unistd.h>
 #include <poll.h>
@@ -37,12 +47,17 @@ namespace stdnet::_Hidden
 }
 
 // ----------------------------------------------------------------------------
+// Each socket with waiting operations has exactly one entry in the poll set
+// and its record knows the position of that entry: cancelling an operation
+// or releasing a socket doesn't need to search the poll set.
 
 struct stdnet::_Hidden::_Poll_record final
 {
-    _Poll_record(::stdnet::_Stdnet_native_handle_type _H): _Handle(_H) {}
-    ::stdnet::_Stdnet_native_handle_type                   _Handle;
     bool                                                   _Blocking{true};
+    bool                                                   _Speculative{false};
+    ::std::size_t                                          _Index{};  // entry in the poll set; 0 if none
+    ::stdnet::_Hidden::_Io_queue                           _Readers;
+    ::stdnet::_Hidden::_Io_queue                           _Writers;
 };
 
 // ----------------------------------------------------------------------------
@@ -51,12 +66,21 @@ struct stdnet::_Hidden::_Poll_context final
     : ::stdnet::_Hidden::_Context_base
 {
     ::stdnet::_Hidden::_Container<::stdnet::_Hidden::_Poll_record> _D_sockets;
-    ::std::vector<::pollfd>     _D_poll;
-    ::std::vector<::stdnet::_Hidden::_Io_base*> _D_outstanding;
+    ::stdnet::_Hidden::_Event_fd _D_wakeup;
+    // The first entry of _D_poll is always the wakeup descriptor. _D_polled
+    // holds the socket corresponding to each entry of _D_poll.
+    ::std::vector<::pollfd>     _D_poll{ ::pollfd{ this->_D_wakeup._Native_handle(), POLLIN, short() } };
+    ::std::vector<::stdnet::_Hidden::_Socket_id> _D_polled{ ::stdnet::_Hidden::_Socket_id::_Invalid };
+    ::std::vector<::stdnet::_Hidden::_Io_base*> _D_ready;
+    ::std::size_t                               _D_next{};
+    ::stdnet::_Hidden::_Timer_wheel             _D_timers;
+    ::stdnet::_Hidden::_Speculation _D_speculation;
 
-    auto _Make_socket(int _Fd) -> ::stdnet::_Hidden::_Socket_id override final
+    auto _Make_socket(int _Fd, bool _Blocking) -> ::stdnet::_Hidden::_Socket_id override final
     {
-        return this->_D_sockets._Insert(_Fd);
+        auto _Id(this->_D_sockets._Insert(_Fd));
+        this->_D_sockets[_Id]._Blocking = _Blocking;
+        return _Id;
     }
     auto _Make_socket(int _D, int _T, int _P, ::std::error_code& _Error)
         -> ::stdnet::_Hidden::_Socket_id override final
@@ -67,20 +91,49 @@ struct stdnet::_Hidden::_Poll_context final
             _Error = ::std::error_code(errno, ::std::system_category());
             return ::stdnet::_Hidden::_Socket_id::_Invalid;
         }
-        return this->_Make_socket(_Fd);
+        return this->_Make_socket(_Fd, true);
     }
+    // Releasing a socket cancels all operations still waiting on it, i.e.,
+    // no stale entries for the closed descriptor remain in the poll set.
     auto _Release(::stdnet::_Hidden::_Socket_id _Id, ::std::error_code& _Error) -> void override final
     {
-        _Stdnet_native_handle_type _Handle(this->_D_sockets[_Id]._Handle);
+        if (!this->_D_sockets._Valid(_Id))
+        {
+            _Error = ::std::error_code(EBADF, ::std::system_category());
+            return;
+        }
+        auto& _Record(this->_D_sockets[_Id]);
+        _Stdnet_native_handle_type _Handle(this->_D_sockets._Handle(_Id));
+        ::stdnet::_Hidden::_Io_queue _Pending;
+        for (auto* _Queue: { &_Record._Readers, &_Record._Writers })
+        {
+            while (::stdnet::_Hidden::_Io_base* _Op = _Queue->_Pop())
+            {
+                this->_Disarm_deadline(_Op);
+                _Pending._Push(_Op);
+            }
+        }
+        this->_Update_events(_Id);
+        for (::std::size_t _I(this->_D_next); _I != this->_D_ready.size(); ++_I)
+        {
+            if (this->_D_ready[_I] && this->_D_ready[_I]->_Event != 0 && this->_D_ready[_I]->_Id == _Id)
+            {
+                _Pending._Push(::std::exchange(this->_D_ready[_I], nullptr));
+            }
+        }
         this->_D_sockets._Erase(_Id);
         if (::close(_Handle) < 0)
         {
             _Error = ::std::error_code(errno, ::std::system_category());
         }
+        while (::stdnet::_Hidden::_Io_base* _Op = _Pending._Pop())
+        {
+            _Op->_Cancel();
+        }
     }
     auto _Native_handle(::stdnet::_Hidden::_Socket_id _Id) -> _Stdnet_native_handle_type override final
     {
-        return this->_D_sockets[_Id]._Handle;
+        return this->_D_sockets._Handle(_Id);
     }
     auto _Set_option(::stdnet::_Hidden::_Socket_id _Id,
                      int _Level,
@@ -89,6 +142,11 @@ struct stdnet::_Hidden::_Poll_context final
                      ::socklen_t _Size,
                      ::std::error_code& _Error) -> void override final
     {
+        if (_Level == ::stdnet::_Hidden::_Stdnet_option_level && _Name == ::stdnet::_Hidden::_Speculative_io_option)
+        {
+            ::stdnet::_Hidden::_Set_speculative(this->_D_sockets[_Id], this->_D_sockets._Handle(_Id), _Data, _Size, _Error);
+            return;
+        }
         if (::setsockopt(this->_Native_handle(_Id), _Level, _Name, _Data, _Size) < 0)
         {
             _Error = ::std::error_code(errno, ::std::system_category());
@@ -108,122 +166,409 @@ struct stdnet::_Hidden::_Poll_context final
         if (::listen(this->_Native_handle(_Id), _No) < 0)
         {
             _Error = ::std::error_code(errno, ::std::system_category());
+            return;
         }
+        // A non-blocking listener allows draining the backlog (see _Accept()).
+        ::stdnet::_Hidden::_Set_nonblocking(this->_D_sockets[_Id], this->_D_sockets._Handle(_Id), _Error);
     }
 
     auto run_one() -> ::std::size_t override final
     {
-        if (this->_D_poll.empty())
-        {
-            return ::std::size_t{};
-        }
+        return this->_Run_some(1u, ::std::chrono::steady_clock::time_point::max());
+    }
+    // _Run_some() completes operations from the ready list. Only when the
+    // ready list is exhausted poll() is called to refill it with all
+    // operations which became ready.
+    auto _Run_some(::std::size_t _Max, ::std::chrono::steady_clock::time_point _Deadline)
+        -> ::std::size_t override final
+    {
+        this->_D_speculation._Reset();
+        this->_Update_now();
+        ::std::size_t _Count(this->_Run_posted());
+        bool          _Waited{false};
         while (true)
         {
-            int _Rc(::poll(this->_D_poll.data(), this->_D_poll.size(), -1));
-            if (_Rc < 0)
+            while (_Count < _Max && this->_D_next != this->_D_ready.size())
             {
-                switch (errno)
+                ::stdnet::_Hidden::_Io_base* _Completion(this->_D_ready[this->_D_next++]);
+                if (_Completion == nullptr)
                 {
-                default:
-                    return ::std::size_t();
-                case EINTR:
-                case EAGAIN:
-                    break;
+                    continue;
                 }
+                if (_Completion->_Work(*this, _Completion))
+                {
+                    ++_Count;
+                }
+                else
+                {
+                    this->_Add_Outstanding(_Completion);
+                }
+            }
+            if (this->_D_next == this->_D_ready.size())
+            {
+                this->_D_ready.clear();
+                this->_D_next = 0u;
+            }
+
+            if (_Count != 0u || (this->_D_poll.size() == 1u && this->_D_timers._Empty()))
+            {
+                return _Count;
+            }
+            if ((_Waited && _Deadline <= this->_Now()) || !this->_Wait(_Deadline))
+            {
+                return ::std::size_t{};
+            }
+            _Waited = true;
+            _Count = this->_Run_posted();
+        }
+    }
+    // _Wait() calls poll() once and moves the first waiting operation of each
+    // ready direction to the ready list, compacting the entries of sockets
+    // without waiting operations in a single pass. The timeout is the
+    // earlier of the deadline and the next timer expiry.
+    auto _Wait(::std::chrono::steady_clock::time_point _Deadline) -> bool
+    {
+        _Deadline = ::std::min(_Deadline, this->_D_timers._Next());
+        int _Timeout(-1);
+        if (_Deadline != ::std::chrono::steady_clock::time_point::max())
+        {
+            auto _Now(this->_Update_now());
+            _Timeout = _Deadline <= _Now
+                ? 0
+                : int(::std::min<::std::chrono::milliseconds::rep>(
+                    ::std::chrono::ceil<::std::chrono::milliseconds>(_Deadline - _Now).count(),
+                    ::std::numeric_limits<int>::max()));
+        }
+        int _Rc(::poll(this->_D_poll.data(), this->_D_poll.size(), _Timeout));
+        if (_Rc < 0)
+        {
+            return errno == EINTR || errno == EAGAIN;
+        }
+        if (this->_D_poll[0].revents & POLLIN)
+        {
+            this->_D_wakeup._Drain();
+        }
+
+        ::std::size_t _To(1u);
+        for (::std::size_t _From(1u), _Size(this->_D_poll.size()); _From != _Size; ++_From)
+        {
+            ::pollfd const& _Entry(this->_D_poll[_From]);
+            auto            _Id(this->_D_polled[_From]);
+            auto&           _Record(this->_D_sockets[_Id]);
+            if ((_Entry.revents & (POLLIN | POLLERR | POLLHUP)) && !_Record._Readers._Empty())
+            {
+                this->_D_ready.push_back(_Record._Readers._Pop());
+                this->_Disarm_deadline(this->_D_ready.back());
+            }
+            if ((_Entry.revents & (POLLOUT | POLLERR | POLLHUP)) && !_Record._Writers._Empty())
+            {
+                this->_D_ready.push_back(_Record._Writers._Pop());
+                this->_Disarm_deadline(this->_D_ready.back());
+            }
+            short _Events(this->_Events(_Record));
+            if (_Events == 0)
+            {
+                _Record._Index = 0u;
             }
             else
             {
-                for (::std::size_t _I(this->_D_poll.size()); 0 < _I--; )
-                {
-                    if (this->_D_poll[_I].revents & (this->_D_poll[_I].events | POLLERR))
-                    {
-                        ::stdnet::_Hidden::_Io_base* _Completion = this->_D_outstanding[_I];
-                        auto _Id{_Completion->_Id};
-                        if (_I + 1u != this->_D_poll.size())
-                        {
-                            this->_D_poll[_I] = this->_D_poll.back();
-                            this->_D_outstanding[_I] = this->_D_outstanding.back();
-                        }
-                        this->_D_poll.pop_back();
-                        this->_D_outstanding.pop_back();
-                        _Completion->_Work(*this, _Completion);
-                        return ::std::size_t(1);
-                    }
-                }
+                this->_D_poll[_To] = ::pollfd{this->_D_sockets._Handle(_Id), _Events, short()};
+                this->_D_polled[_To] = _Id;
+                _Record._Index = _To++;
             }
         }
-        return ::std::size_t{};
+        this->_D_poll.resize(_To);
+        this->_D_polled.resize(_To);
+
+        this->_Update_now();
+        if (!this->_D_timers._Empty())
+        {
+            this->_D_timers._Expire(this->_Now(),
+                                    [this](::stdnet::_Hidden::_Io_base* _Op){ this->_Expired(_Op); });
+        }
+        return true;
     }
-    auto _Wakeup() -> void
+    auto _Wakeup() -> void override final
     {
-        //-dk:TODO wake-up polling thread
+        this->_D_wakeup._Signal();
     }
 
     auto _Add_Outstanding(::stdnet::_Hidden::_Io_base* _Completion) -> bool
     {
-        auto _Id{_Completion->_Id};
-        if (this->_D_sockets[_Id]._Blocking || !_Completion->_Work(*this, _Completion))
+        auto  _Id{_Completion->_Id};
+        auto& _Record(this->_D_sockets[_Id]);
+        (_Completion->_Event == POLLIN? _Record._Readers: _Record._Writers)._Push(_Completion);
+        if (_Record._Index == 0u)
         {
-            this->_D_poll.emplace_back(::pollfd{this->_Native_handle(_Id), short(_Completion->_Event), short()});
-            this->_D_outstanding.emplace_back(_Completion);
-            this->_Wakeup();
-            return false;
+            _Record._Index = this->_D_poll.size();
+            this->_D_poll.emplace_back(::pollfd{this->_D_sockets._Handle(_Id), short(_Completion->_Event), short()});
+            this->_D_polled.emplace_back(_Id);
         }
+        else
+        {
+            this->_D_poll[_Record._Index].events |= short(_Completion->_Event);
+        }
+        this->_Arm_deadline(_Completion);
         return true;
     }
+    static auto _Events(::stdnet::_Hidden::_Poll_record const& _Record) -> short
+    {
+        return short((_Record._Readers._Empty()? 0: POLLIN) | (_Record._Writers._Empty()? 0: POLLOUT));
+    }
+    // _Update_events() adjusts the poll set after operations were removed
+    // from a socket: the socket's entry is dropped when nothing waits on it.
+    auto _Update_events(::stdnet::_Hidden::_Socket_id _Id) -> void
+    {
+        auto&         _Record(this->_D_sockets[_Id]);
+        ::std::size_t _Index(_Record._Index);
+        if (_Index == 0u)
+        {
+            return;
+        }
+        if (short _Events = this->_Events(_Record))
+        {
+            this->_D_poll[_Index].events = _Events;
+            return;
+        }
+        this->_D_poll[_Index]   = this->_D_poll.back();
+        this->_D_polled[_Index] = this->_D_polled.back();
+        this->_D_sockets[this->_D_polled[_Index]]._Index = _Index;
+        this->_D_poll.pop_back();
+        this->_D_polled.pop_back();
+        _Record._Index = 0u;
+    }
 
-    auto _Cancel(::stdnet::_Hidden::_Io_base*, ::stdnet::_Hidden::_Io_base*) -> void override final
+    // Socket operations with a deadline have a timer node in their deadline
+    // storage while they are waiting. When the timer expires first, the
+    // operation is removed from its queue and completes with a timeout.
+    auto _Arm_deadline(::stdnet::_Hidden::_Io_base* _Op) -> void
+    {
+        static_assert(sizeof(::stdnet::_Hidden::_Timer_node) <= sizeof(_Timer_storage));
+        if (_Op->_Deadline)
+        {
+            auto _Node(::new(static_cast<void*>(_Op->_Deadline->_Storage._Data)) ::stdnet::_Hidden::_Timer_node());
+            _Node->_Op = _Op;
+            this->_D_timers._Insert(_Node, _Op->_Deadline->_Resolve(this->_Now()));
+        }
+    }
+    auto _Disarm_deadline(::stdnet::_Hidden::_Io_base* _Op) -> void
     {
-        //-dk:TODO
+        if (_Op->_Deadline)
+        {
+            this->_D_timers._Erase(::std::launder(reinterpret_cast<::stdnet::_Hidden::_Timer_node*>(_Op->_Deadline->_Storage._Data)));
+        }
     }
+    auto _Expired(::stdnet::_Hidden::_Io_base* _Op) -> void
+    {
+        if (_Op->_Event != 0)
+        {
+            auto& _Record(this->_D_sockets[_Op->_Id]);
+            (_Op->_Event == POLLIN? _Record._Readers: _Record._Writers)._Erase(_Op);
+            this->_Update_events(_Op->_Id);
+            _Op->_Work = ::stdnet::_Hidden::_Timeout_work;
+        }
+        this->_D_ready.push_back(_Op);
+    }
+    // _Submit() tries the operation right away if speculative I/O is enabled
+    // for the socket and no other operation is waiting in the same direction.
+    template <typename _Try>
+    auto _Submit(::stdnet::_Hidden::_Io_base* _Completion, _Try _T) -> bool
+    {
+        _Completion->_Context = this;
+        auto& _Record(this->_D_sockets[_Completion->_Id]);
+        bool _Idle((_Completion->_Event == POLLIN? _Record._Readers: _Record._Writers)._Empty());
+        if (auto _Rc = this->_D_speculation._Attempt(_Record._Speculative && _Idle, *this, _Completion, _T))
+        {
+            return *_Rc;
+        }
+        return this->_Add_Outstanding(_Completion);
+    }
+
+    auto _Add_timer(::stdnet::_Hidden::_Io_base* _Op,
+                    _Timer_storage& _Storage,
+                    ::std::chrono::steady_clock::time_point _Time) -> void
+    {
+        static_assert(sizeof(::stdnet::_Hidden::_Timer_node) <= sizeof(_Timer_storage));
+        _Op->_Context = this;
+        _Op->_Event   = 0;
+        _Op->_Work    = [](::stdnet::_Hidden::_Context_base&, ::stdnet::_Hidden::_Io_base* _Op)
+            {
+                _Op->_Complete();
+                return true;
+            };
+        auto _Node(::new(static_cast<void*>(_Storage._Data)) ::stdnet::_Hidden::_Timer_node());
+        _Node->_Op  = _Op;
+        _Op->_Extra = ::stdnet::_Hidden::_Io_base::_Extra_t(_Node, +[](void*){});
+        this->_D_timers._Insert(_Node, _Time);
+    }
+
+    auto _Cancel(::stdnet::_Hidden::_Cancel_node* _Node) -> void override final
+    {
+        ::stdnet::_Hidden::_Io_base* _Op(_Node->_Op);
+        bool _Found{false};
+        if (_Op->_Event == 0)
+        {
+            _Found = this->_D_timers._Erase(static_cast<::stdnet::_Hidden::_Timer_node*>(_Op->_Extra.get()));
+        }
+        else if (this->_D_sockets._Valid(_Op->_Id)) // a posted cancellation may arrive after _Release()
+        {
+            auto& _Record(this->_D_sockets[_Op->_Id]);
+            if ((_Op->_Event == POLLIN? _Record._Readers: _Record._Writers)._Erase(_Op))
+            {
+                this->_Update_events(_Op->_Id);
+                this->_Disarm_deadline(_Op);
+                _Found = true;
+            }
+        }
+        for (::std::size_t _I(this->_D_next); !_Found && _I != this->_D_ready.size(); ++_I)
+        {
+            if (this->_D_ready[_I] == _Op)
+            {
+                this->_D_ready[_I] = nullptr;
+                _Found = true;
+            }
+        }
+        _Node->_Done(_Node);
+        if (_Found)
+        {
+            _Op->_Cancel();
+        }
+    }
+    // Once a waiting accept got a connection, the next waiting accept on the
+    // same listener is made ready, too: a burst of connections is accepted
+    // without a poll() per connection.
     auto _Accept(::stdnet::_Hidden::_Context_base::_Accept_operation* _Completion)
         -> bool override final
     {
-        auto _Id(_Completion->_Id);
-        _Completion->_Work =
-            [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Comp)
+        _Completion->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
             {
-                auto _Id{_Comp->_Id};
-                auto& _Completion(*static_cast<_Accept_operation*>(_Comp));
-
-                while (true)
+                auto _Result(::stdnet::_Hidden::_Try_accept(_Ctxt, _Op));
+                if (_Result == ::stdnet::_Hidden::_Io_result::_Done)
                 {
-                    int _Rc = ::accept(_Ctxt._Native_handle(_Id), ::std::get<0>(_Completion)._Data(), &::std::get<1>(_Completion));
-                    if (0 <= _Rc)
-                    {
-                        ::std::get<2>(_Completion) =  _Ctxt._Make_socket(_Rc);
-                        _Completion._Complete();
-                        return true;
-                    }
-                    else
-                    {
-                        switch (errno)
-                        {
-                        default:
-                            _Completion._Error(::std::error_code(errno, ::std::system_category()));
-                            return true;
-                        case EINTR:
-                            break;
-                        case EWOULDBLOCK:
-                            return false;
-                        }
-                    }
+                    static_cast<::stdnet::_Hidden::_Poll_context&>(_Ctxt)._Ready_next(_Op->_Id);
                 }
+                return ::stdnet::_Hidden::_Finish_work(_Result, _Op);
             };
+        _Completion->_Event = POLLIN;
+        return this->_Submit(_Completion, ::stdnet::_Hidden::_Try_accept);
+    }
+    // A multishot operation is queued again before each completion: the
+    // completion may release the socket or cancel the operation. Together
+    // with _Ready_next() the operation is repeated until it would block.
+    template <auto _Try>
+    static auto _Multishot_work(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op) -> bool
+    {
+        auto _Result(_Try(_Ctxt, _Op));
+        if (_Result != ::stdnet::_Hidden::_Io_result::_Done)
+        {
+            return _Result == ::stdnet::_Hidden::_Io_result::_Failed;
+        }
+        auto& _Context(static_cast<::stdnet::_Hidden::_Poll_context&>(_Ctxt));
+        _Context._Add_Outstanding(_Op);
+        _Context._Ready_next(_Op->_Id);
+        _Op->_Complete();
+        return true;
+    }
+    auto _Accept_multishot(::stdnet::_Hidden::_Context_base::_Accept_operation* _Completion)
+        -> bool override final
+    {
+        _Completion->_Work    = _Multishot_work<::stdnet::_Hidden::_Try_accept>;
+        _Completion->_Context = this;
+        _Completion->_Event   = POLLIN;
+        return this->_Add_Outstanding(_Completion);
+    }
+    auto _Ready_next(::stdnet::_Hidden::_Socket_id _Id) -> void
+    {
+        auto& _Record(this->_D_sockets[_Id]);
+        if (!_Record._Blocking && !_Record._Readers._Empty())
+        {
+            this->_D_ready.push_back(_Record._Readers._Pop());
+            this->_Disarm_deadline(this->_D_ready.back());
+            this->_Update_events(_Id);
+        }
+    }
+    auto _Connect(::stdnet::_Hidden::_Context_base::_Connect_operation* _Completion) -> bool override
+    {
+        auto& _Record(this->_D_sockets[_Completion->_Id]);
+        auto _Handle(this->_D_sockets._Handle(_Completion->_Id));
+        auto const& _Endpoint(::std::get<0>(*_Completion));
+        int _Flags(::fcntl(_Handle, F_GETFL));
+        if (_Flags < 0 || ::fcntl(_Handle, F_SETFL, _Flags | O_NONBLOCK) < 0)
+        {
+            _Completion->_Error(::std::error_code(errno, ::std::system_category()));
+            return true;
+        }
+        _Record._Blocking = false;
+        if (0 == ::connect(_Handle, _Endpoint._Data(), _Endpoint._Size()))
+        {
+            return false;
+        }
+        if (errno != EINPROGRESS && errno != EINTR)
+        {
+            _Completion->_Error(::std::error_code(errno, ::std::system_category()));
+            return true;
+        }
+        _Completion->_Context = this;
+        _Completion->_Work    = ::stdnet::_Hidden::_Connect_work;
+        _Completion->_Event   = POLLOUT;
+        return this->_Add_Outstanding(_Completion);
+    }
+    auto _Receive(::stdnet::_Hidden::_Context_base::_Receive_operation* _Completion) -> bool override
+    {
+        _Completion->_Work = ::stdnet::_Hidden::_Receive_work;
+        _Completion->_Event = POLLIN;
+        return this->_Submit(_Completion, ::stdnet::_Hidden::_Try_receive);
+    }
+    // The socket is made non-blocking such that the multishot receive can
+    // be repeated until it would block.
+    auto _Receive_multishot(::stdnet::_Hidden::_Context_base::_Receive_multishot_operation* _Completion)
+        -> bool override
+    {
+        ::std::error_code _Error;
+        ::stdnet::_Hidden::_Set_nonblocking(this->_D_sockets[_Completion->_Id], this->_D_sockets._Handle(_Completion->_Id), _Error);
+        if (_Error)
+        {
+            _Completion->_Error(_Error);
+            return true;
+        }
+        _Completion->_Work    = _Multishot_work<::stdnet::_Hidden::_Try_receive_multishot>;
+        _Completion->_Context = this;
+        _Completion->_Event   = POLLIN;
         return this->_Add_Outstanding(_Completion);
     }
-    auto _Connect(::stdnet::_Hidden::_Context_base::_Connect_operation* _Completion) -> bool override { return {}; /*-dk:TODO*/ } 
-    auto _Receive(::stdnet::_Hidden::_Context_base::_Receive_operation*) -> bool override { return {}; /*-dk:TODO*/ }
-    auto _Send(::stdnet::_Hidden::_Context_base::_Send_operation*) -> bool override { return {}; /*-dk:TODO*/ }
-    auto _Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation*) -> bool override
+    auto _Send(::stdnet::_Hidden::_Context_base::_Send_operation* _Completion) -> bool override
     {
-        //-dk:TODO
-        return {};
+        _Completion->_Work = ::stdnet::_Hidden::_Send_work;
+        _Completion->_Event = POLLOUT;
+        return this->_Submit(_Completion, ::stdnet::_Hidden::_Try_send);
     }
-    auto _Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation*) -> bool override
+    auto _Sendfile(::stdnet::_Hidden::_Context_base::_Sendfile_operation* _Completion) -> bool override
     {
-        //-dk:TODO
-        return {};
+        ::std::error_code _Error;
+        ::stdnet::_Hidden::_Set_nonblocking(this->_D_sockets[_Completion->_Id], this->_D_sockets._Handle(_Completion->_Id), _Error);
+        if (_Error)
+        {
+            _Completion->_Error(_Error);
+            return true;
+        }
+        _Completion->_Work = ::stdnet::_Hidden::_Sendfile_work;
+        _Completion->_Event = POLLOUT;
+        return this->_Submit(_Completion, ::stdnet::_Hidden::_Try_sendfile);
+    }
+    auto _Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation* _Op) -> bool override
+    {
+        this->_Add_timer(_Op, ::std::get<1>(*_Op), this->_Now() + ::std::get<0>(*_Op));
+        return true;
+    }
+    auto _Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation* _Op) -> bool override
+    {
+        auto _Time(::std::get<0>(*_Op));
+        if (_Time <= this->_Now())
+        {
+            return false;
+        }
+        this->_Add_timer(_Op, ::std::get<1>(*_Op), _Time);
+        return true;
     }
 };
 
@@ -0,0 +1,183 @@
+// stdnet/receive_pool.hpp                                            -*-C++-*-
+// ----------------------------------------------------------------------------
+/*
+ * Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_STDNET_RECEIVE_POOL
+#define INCLUDED_STDNET_RECEIVE_POOL
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace stdnet
+{
+    class receive_buffer;
+
+    namespace _Hidden
+    {
+        class _Receive_pool;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// The _Receive_pool of a context provides the buffers for multishot receives:
+// a buffer is only taken when data arrives and the filled buffer is handed to
+// the consumer as a receive_buffer which gives it back when destroyed. The
+// memory is allocated when the first buffer is needed, i.e., contexts not
+// using multishot receives don't pay for it. The pool isn't thread-safe:
+// buffers need to be released on the thread running the context.
+//
+// A context may hand all buffers to the kernel instead (the io_uring context
+// uses provided buffers): it takes the buffers once and installs a recycle
+// function which is called with the buffers given back.
+
+class stdnet::_Hidden::_Receive_pool
+{
+public:
+    using _Index = ::std::uint16_t;
+
+private:
+    ::std::size_t             _D_count;
+    ::std::size_t             _D_size;
+    ::std::unique_ptr<char[]> _D_memory;
+    ::std::vector<_Index>     _D_free;
+    void*                     _D_owner{};
+    auto                    (*_D_recycle)(void*, _Index) -> void{};
+
+public:
+    // The count is limited by the 16 bit buffer ids used by io_uring.
+    _Receive_pool(::std::size_t _Count = 1024u, ::std::size_t _Size = 4096u)
+        : _D_count(_Count)
+        , _D_size(_Size)
+    {
+    }
+    _Receive_pool(_Receive_pool&&) = delete;
+
+    auto _Configure(::std::size_t _Count, ::std::size_t _Size) -> void
+    {
+        assert(!this->_D_memory && 0u < _Count && _Count <= 32768u);
+        this->_D_count = _Count;
+        this->_D_size  = _Size;
+    }
+    auto _Count() const -> ::std::size_t { return this->_D_count; }
+    auto _Size() const -> ::std::size_t { return this->_D_size; }
+    auto _Data(_Index _I) -> char* { return this->_D_memory.get() + _I * this->_D_size; }
+
+    auto _Allocate() -> void
+    {
+        if (!this->_D_memory)
+        {
+            this->_D_memory = ::std::make_unique_for_overwrite<char[]>(this->_D_count * this->_D_size);
+            this->_D_free.reserve(this->_D_count);
+            for (::std::size_t _I(this->_D_count); _I != 0u; --_I)
+            {
+                this->_D_free.push_back(_Index(_I - 1u));
+            }
+        }
+    }
+    // _Take() returns the index of an unused buffer or -1 if there is none.
+    auto _Take() -> int
+    {
+        this->_Allocate();
+        if (this->_D_free.empty())
+        {
+            return -1;
+        }
+        int _Rc(this->_D_free.back());
+        this->_D_free.pop_back();
+        return _Rc;
+    }
+    auto _Return(_Index _I) -> void
+    {
+        if (this->_D_recycle)
+        {
+            this->_D_recycle(this->_D_owner, _I);
+        }
+        else
+        {
+            this->_D_free.push_back(_I);
+        }
+    }
+    auto _Set_recycle(void* _Owner, auto (*_Recycle)(void*, _Index) -> void) -> void
+    {
+        this->_D_owner   = _Owner;
+        this->_D_recycle = _Recycle;
+    }
+};
+
+// ----------------------------------------------------------------------------
+// A receive_buffer owns a filled buffer of a context's receive pool until it
+// is destroyed or reset(). It needs to be released on the thread running the
+// context and before the context is destroyed.
+
+class stdnet::receive_buffer
+{
+private:
+    ::stdnet::_Hidden::_Receive_pool*        _D_pool{};
+    ::stdnet::_Hidden::_Receive_pool::_Index _D_index{};
+    ::std::size_t                            _D_size{};
+
+public:
+    receive_buffer() = default;
+    receive_buffer(::stdnet::_Hidden::_Receive_pool* _Pool,
+                   ::stdnet::_Hidden::_Receive_pool::_Index _Index,
+                   ::std::size_t _Size)
+        : _D_pool(_Pool)
+        , _D_index(_Index)
+        , _D_size(_Size)
+    {
+    }
+    receive_buffer(receive_buffer&& _Other)
+        : _D_pool(::std::exchange(_Other._D_pool, nullptr))
+        , _D_index(_Other._D_index)
+        , _D_size(::std::exchange(_Other._D_size, 0u))
+    {
+    }
+    auto operator=(receive_buffer&& _Other) -> receive_buffer&
+    {
+        if (this != &_Other)
+        {
+            this->reset();
+            this->_D_pool  = ::std::exchange(_Other._D_pool, nullptr);
+            this->_D_index = _Other._D_index;
+            this->_D_size  = ::std::exchange(_Other._D_size, 0u);
+        }
+        return *this;
+    }
+    ~receive_buffer() { this->reset(); }
+
+    auto data() const -> char* { return this->_D_pool? this->_D_pool->_Data(this->_D_index): nullptr; }
+    auto size() const -> ::std::size_t { return this->_D_size; }
+    auto reset() -> void
+    {
+        if (this->_D_pool)
+        {
+            ::std::exchange(this->_D_pool, nullptr)->_Return(this->_D_index);
+            this->_D_size = 0u;
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -28,11 +28,17 @@
 #include <stdnet/basic_stream_socket.hpp>
 #include <stdnet/io_context.hpp>
 #include <stdnet/internet.hpp>
+#include <stdnet/timer.hpp>
+#include <stdnet/dynamic_buffer.hpp>
 
 #include <stdexec/functional.hpp>
+#include <algorithm>
 #include <system_error>
 #include <type_traits>
+#include <utility>
 #include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
 #include <poll.h>
 #include <unistd.h>
 #include <cerrno>
@@ -49,15 +55,25 @@ namespace stdnet
     namespace _Hidden
     {
         struct _Accept_desc;
+        struct _Accept_each_desc;
         struct _Connect_desc;
         struct _Send_desc;
         struct _Send_to_desc;
         struct _Receive_desc;
+        struct _Receive_each_desc;
         struct _Receive_from_desc;
+        struct _Write_all_desc;
+        struct _Read_exactly_desc;
+        struct _Read_at_least_desc;
+        struct _Read_until_desc;
+        struct _Send_zerocopy_desc;
+        struct _Sendfile_desc;
     }
 
     using async_accept_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Accept_desc>;
     inline constexpr async_accept_t async_accept{};
+    using async_accept_each_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Accept_each_desc>;
+    inline constexpr async_accept_each_t async_accept_each{};
     using async_connect_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Connect_desc>;
     inline constexpr async_connect_t async_connect{};
     using async_send_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Send_desc>;
@@ -66,10 +82,30 @@ namespace stdnet
     inline constexpr async_send_to_t async_send_to{};
     using async_receive_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Receive_desc>;
     inline constexpr async_receive_t async_receive{};
+    using async_receive_each_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Receive_each_desc>;
+    inline constexpr async_receive_each_t async_receive_each{};
     using async_receive_from_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Receive_from_desc>;
     inline constexpr async_receive_from_t async_receive_from{};
+    using async_write_all_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Write_all_desc>;
+    inline constexpr async_write_all_t async_write_all{};
+    using async_read_exactly_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Read_exactly_desc>;
+    inline constexpr async_read_exactly_t async_read_exactly{};
+    using async_read_at_least_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Read_at_least_desc>;
+    inline constexpr async_read_at_least_t async_read_at_least{};
+    using async_read_until_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Read_until_desc>;
+    inline constexpr async_read_until_t async_read_until{};
+    using async_send_zerocopy_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Send_zerocopy_desc>;
+    inline constexpr async_send_zerocopy_t async_send_zerocopy{};
+    using async_sendfile_t = ::stdnet::_Hidden::_Cpo<::stdnet::_Hidden::_Sendfile_desc>;
+    inline constexpr async_sendfile_t async_sendfile{};
 }
 
+// ----------------------------------------------------------------------------
+// async_connect(), async_send(), and async_receive() accept an optional
+// timeout as last argument (a duration or a time_point). If the operation
+// doesn't complete in time, it completes with
+// set_error(make_error_code(errc::timed_out)).
+
 struct stdnet::_Hidden::_Accept_desc
 {
     using _Operation = ::stdnet::_Hidden::_Context_base::_Accept_operation;
@@ -102,15 +138,55 @@ struct stdnet::_Hidden::_Accept_desc
     };
 };
 
+// async_accept_each(acceptor, fun) keeps accepting connections using one
+// operation and calls fun(socket, endpoint) for each of them on the thread
+// running the context. It completes with set_value() once the acceptor is
+// closed and with set_stopped() when stopped.
+
+struct stdnet::_Hidden::_Accept_each_desc
+{
+    using _Operation = ::stdnet::_Hidden::_Context_base::_Accept_operation;
+    template <typename _Acceptor, typename _Fun>
+    struct _Data
+    {
+        using _Acceptor_t = ::std::remove_cvref_t<_Acceptor>;
+        using _Socket_t = _Acceptor_t::socket_type;
+        using _Completion_signature = ::stdexec::set_value_t();
+        static constexpr bool _Multishot{true};
+
+        _Acceptor_t&                _D_acceptor;
+        ::std::remove_cvref_t<_Fun> _D_fun;
+
+        auto _Id() const { return this->_D_acceptor._Id(); }
+        auto _Events() const { return POLLIN; }
+        auto _Get_scheduler() { return this->_D_acceptor.get_scheduler(); }
+        auto _Deliver(_Operation& _O)
+        {
+            this->_D_fun(_Socket_t(this->_D_acceptor.get_scheduler()._Get_context(),
+                                   ::std::move(*::std::get<2>(_O))),
+                         typename _Socket_t::endpoint_type(::std::get<0>(_O)));
+        }
+        auto _Set_value(_Operation&, auto&& _Receiver)
+        {
+            ::stdexec::set_value(::std::move(_Receiver));
+        }
+        auto _Submit(auto* _Base) -> bool
+        {
+            return this->_D_acceptor.get_scheduler()._Accept_multishot(_Base);
+        }
+    };
+};
+
 struct stdnet::_Hidden::_Connect_desc
 {
     using _Operation = ::stdnet::_Hidden::_Context_base::_Connect_operation;
-    template <typename _Socket>
+    template <typename _Socket, typename... _Timeout>
     struct _Data
     {
         using _Completion_signature = ::stdexec::set_value_t();
 
-        _Socket& _D_socket;
+        _Socket&                                    _D_socket;
+        ::stdnet::_Hidden::_Io_timeout<_Timeout...> _D_timeout{};
 
         auto _Id() const { return this->_D_socket._Id(); }
         auto _Events() const { return POLLIN; }
@@ -122,6 +198,7 @@ struct stdnet::_Hidden::_Connect_desc
         auto _Submit(auto* _Base) -> bool
         {
             ::std::get<0>(*_Base) = this->_D_socket.get_endpoint();
+            this->_D_timeout._Apply(_Base);
             return this->_D_socket.get_scheduler()._Connect(_Base);
         }
     };
@@ -130,13 +207,14 @@ struct stdnet::_Hidden::_Connect_desc
 struct stdnet::_Hidden::_Send_desc
 {
     using _Operation = ::stdnet::_Hidden::_Context_base::_Send_operation;
-    template <typename _Stream_t, typename _Buffers>
+    template <typename _Stream_t, typename _Buffers, typename... _Timeout>
     struct _Data
     {
         using _Completion_signature = ::stdexec::set_value_t(::std::size_t);
 
-        _Stream_t& _D_stream;
-        _Buffers   _D_buffers;
+        _Stream_t&                                  _D_stream;
+        _Buffers                                    _D_buffers;
+        ::stdnet::_Hidden::_Io_timeout<_Timeout...> _D_timeout{};
 
         auto _Id() const { return this->_D_stream._Id(); }
         auto _Events() const { return POLLIN; }
@@ -150,6 +228,7 @@ struct stdnet::_Hidden::_Send_desc
         {
             ::std::get<0>(*_Base).msg_iov    = this->_D_buffers.data();
             ::std::get<0>(*_Base).msg_iovlen = this->_D_buffers.size();
+            this->_D_timeout._Apply(_Base);
             return this->_D_stream.get_scheduler()._Send(_Base);
         }
     };
@@ -188,13 +267,14 @@ struct stdnet::_Hidden::_Send_to_desc
 struct stdnet::_Hidden::_Receive_desc
 {
     using _Operation = ::stdnet::_Hidden::_Context_base::_Receive_operation;
-    template <typename _Stream_t, typename _Buffers>
+    template <typename _Stream_t, typename _Buffers, typename... _Timeout>
     struct _Data
     {
         using _Completion_signature = ::stdexec::set_value_t(::std::size_t);
 
-        _Stream_t& _D_stream;
-        _Buffers   _D_buffers;
+        _Stream_t&                                  _D_stream;
+        _Buffers                                    _D_buffers;
+        ::stdnet::_Hidden::_Io_timeout<_Timeout...> _D_timeout{};
 
         auto _Id() const { return this->_D_stream._Id(); }
         auto _Events() const { return POLLIN; }
@@ -207,11 +287,51 @@ struct stdnet::_Hidden::_Receive_desc
         {
             ::std::get<0>(*_Base).msg_iov    = this->_D_buffers.data();
             ::std::get<0>(*_Base).msg_iovlen = this->_D_buffers.size();
+            this->_D_timeout._Apply(_Base);
             return this->_D_stream.get_scheduler()._Receive(_Base);
         }
     };
 };
 
+// async_receive_each(stream, fun) keeps receiving using one operation and
+// calls fun(receive_buffer) for each chunk received into a buffer of the
+// context's receive pool (see io_context::set_receive_buffers()). It
+// completes with set_value() when the peer shuts the connection down or the
+// stream is closed, with set_error() using ENOBUFS when all buffers are
+// held, and with set_stopped() when stopped.
+
+struct stdnet::_Hidden::_Receive_each_desc
+{
+    using _Operation = ::stdnet::_Hidden::_Context_base::_Receive_multishot_operation;
+    template <typename _Stream_t, typename _Fun>
+    struct _Data
+    {
+        using _Completion_signature = ::stdexec::set_value_t();
+        static constexpr bool _Multishot{true};
+
+        _Stream_t&                  _D_stream;
+        ::std::remove_cvref_t<_Fun> _D_fun;
+
+        auto _Id() const { return this->_D_stream._Id(); }
+        auto _Events() const { return POLLIN; }
+        auto _Get_scheduler() { return this->_D_stream.get_scheduler(); }
+        auto _Deliver(_Operation& _O)
+        {
+            this->_D_fun(::stdnet::receive_buffer(&this->_D_stream.get_scheduler()._Get_context()->_D_receive_pool,
+                                                  ::std::get<1>(_O), ::std::get<2>(_O)));
+        }
+        auto _Set_value(_Operation&, auto&& _Receiver)
+        {
+            ::stdexec::set_value(::std::move(_Receiver));
+        }
+        auto _Submit(auto* _Base) -> bool
+        {
+            ::std::get<0>(*_Base) = 0;
+            return this->_D_stream.get_scheduler()._Receive_multishot(_Base);
+        }
+    };
+};
+
 struct stdnet::_Hidden::_Receive_from_desc
 {
     using _Operation = ::stdnet::_Hidden::_Context_base::_Receive_operation;
@@ -242,6 +362,414 @@ struct stdnet::_Hidden::_Receive_from_desc
     };
 };
 
+// ----------------------------------------------------------------------------
+// async_write_all(stream, buffers), async_read_exactly(stream, buffers), and
+// async_read_at_least(stream, buffers, size) transfer the buffers using one
+// operation: after a partial transfer the remainder is attempted right away
+// and readiness is only awaited when the socket would block. They complete
+// with the number of bytes transferred which is less than requested only if
+// the stream ended. Like async_send() they accept an optional timeout. The
+// buffers are copied into the operation, i.e., a buffer_sequence passed in
+// isn't consumed.
+
+namespace stdnet::_Hidden
+{
+    template <typename _Buffers>
+    auto _Buffers_size(_Buffers& _B) -> ::std::size_t
+    {
+        ::std::size_t _Size{};
+        for (::std::size_t _I{}; _I != _B.size(); ++_I)
+        {
+            _Size += _B.data()[_I].iov_len;
+        }
+        return _Size;
+    }
+}
+
+struct stdnet::_Hidden::_Write_all_desc
+{
+    using _Operation = ::stdnet::_Hidden::_Context_base::_Send_operation;
+    template <typename _Stream_t, typename _Buffers, typename... _Timeout>
+    struct _Data
+    {
+        using _Completion_signature = ::stdexec::set_value_t(::std::size_t);
+
+        _Stream_t&                                  _D_stream;
+        ::std::remove_cvref_t<_Buffers>             _D_buffers;
+        ::stdnet::_Hidden::_Io_timeout<_Timeout...> _D_timeout{};
+
+        auto _Id() const { return this->_D_stream._Id(); }
+        auto _Events() const { return POLLOUT; }
+        auto _Get_scheduler() { return this->_D_stream.get_scheduler(); }
+        auto _Set_value(_Operation& _O, auto&& _Receiver)
+        {
+            ::stdexec::set_value(::std::move(_Receiver), ::std::get<2>(_O));
+        }
+        auto _Submit(auto* _Base) -> bool
+        {
+            ::std::get<0>(*_Base).msg_iov    = this->_D_buffers.data();
+            ::std::get<0>(*_Base).msg_iovlen = this->_D_buffers.size();
+            ::std::get<3>(*_Base)            = ::stdnet::_Hidden::_Buffers_size(this->_D_buffers);
+            this->_D_timeout._Apply(_Base);
+            return this->_D_stream.get_scheduler()._Send(_Base);
+        }
+    };
+};
+
+struct stdnet::_Hidden::_Read_exactly_desc
+{
+    using _Operation = ::stdnet::_Hidden::_Context_base::_Receive_operation;
+    template <typename _Stream_t, typename _Buffers, typename... _Timeout>
+    struct _Data
+    {
+        using _Completion_signature = ::stdexec::set_value_t(::std::size_t);
+
+        _Stream_t&                                  _D_stream;
+        ::std::remove_cvref_t<_Buffers>             _D_buffers;
+        ::stdnet::_Hidden::_Io_timeout<_Timeout...> _D_timeout{};
+
+        auto _Id() const { return this->_D_stream._Id(); }
+        auto _Events() const { return POLLIN; }
+        auto _Get_scheduler() { return this->_D_stream.get_scheduler(); }
+        auto _Set_value(_Operation& _O, auto&& _Receiver)
+        {
+            ::stdexec::set_value(::std::move(_Receiver), ::std::get<2>(_O));
+        }
+        auto _Submit(auto* _Base) -> bool
+        {
+            ::std::get<0>(*_Base).msg_iov    = this->_D_buffers.data();
+            ::std::get<0>(*_Base).msg_iovlen = this->_D_buffers.size();
+            ::std::get<3>(*_Base)            = ::stdnet::_Hidden::_Buffers_size(this->_D_buffers);
+            this->_D_timeout._Apply(_Base);
+            return this->_D_stream.get_scheduler()._Receive(_Base);
+        }
+    };
+};
+
+struct stdnet::_Hidden::_Read_at_least_desc
+{
+    using _Operation = ::stdnet::_Hidden::_Context_base::_Receive_operation;
+    template <typename _Stream_t, typename _Buffers, typename _Size, typename... _Timeout>
+    struct _Data
+    {
+        using _Completion_signature = ::stdexec::set_value_t(::std::size_t);
+
+        _Stream_t&                                  _D_stream;
+        ::std::remove_cvref_t<_Buffers>             _D_buffers;
+        ::std::remove_cvref_t<_Size>                _D_size;
+        ::stdnet::_Hidden::_Io_timeout<_Timeout...> _D_timeout{};
+
+        auto _Id() const { return this->_D_stream._Id(); }
+        auto _Events() const { return POLLIN; }
+        auto _Get_scheduler() { return this->_D_stream.get_scheduler(); }
+        auto _Set_value(_Operation& _O, auto&& _Receiver)
+        {
+            ::stdexec::set_value(::std::move(_Receiver), ::std::get<2>(_O));
+        }
+        auto _Submit(auto* _Base) -> bool
+        {
+            ::std::get<0>(*_Base).msg_iov    = this->_D_buffers.data();
+            ::std::get<0>(*_Base).msg_iovlen = this->_D_buffers.size();
+            ::std::get<3>(*_Base)            = ::std::min(::std::size_t(this->_D_size),
+                                                          ::stdnet::_Hidden::_Buffers_size(this->_D_buffers));
+            this->_D_timeout._Apply(_Base);
+            return this->_D_stream.get_scheduler()._Receive(_Base);
+        }
+    };
+};
+
+// ----------------------------------------------------------------------------
+// async_read_until(stream, buffer, delimiter) receives into a dynamic_buffer
+// until it contains the delimiter (a character or a string) and completes
+// with the number of bytes up to and including the delimiter, leaving these
+// and any bytes received after them in the buffer. The bytes already
+// present are searched first. After each receive only the new bytes (and
+// the preceding bytes which may start a delimiter) are searched. It
+// completes with 0 if the stream ended without a delimiter and with
+// set_error(stream_errc::not_found) if the buffer reached its max_size().
+
+namespace stdnet::_Hidden
+{
+    struct _Read_delimiter
+    {
+        ::std::string _D_value;
+
+        _Read_delimiter(char _C): _D_value(1u, _C) {}
+        _Read_delimiter(::std::string_view _S): _D_value(_S) {}
+        _Read_delimiter(char const* _S): _D_value(_S) {}
+        _Read_delimiter(::std::string const& _S): _D_value(_S) {}
+    };
+}
+
+struct stdnet::_Hidden::_Read_until_desc
+{
+    using _Operation = ::stdnet::_Hidden::_Context_base::_Receive_operation;
+    template <typename _Stream_t, typename _Buffer, typename _Delimiter>
+    struct _Data
+    {
+        using _Completion_signature = ::stdexec::set_value_t(::std::size_t);
+        static constexpr bool _Continued{true};
+        static constexpr ::std::size_t _Receive_size{4096u};
+
+        _Stream_t&                         _D_stream;
+        ::stdnet::dynamic_buffer&          _D_buffer;
+        ::stdnet::_Hidden::_Read_delimiter _D_delimiter;
+        ::std::size_t                      _D_searched{};
+        bool                               _D_found{};
+        ::iovec                            _D_vec{};
+
+        auto _Id() const { return this->_D_stream._Id(); }
+        auto _Events() const { return POLLIN; }
+        auto _Get_scheduler() { return this->_D_stream.get_scheduler(); }
+        auto _Set_value(_Operation& _O, auto&& _Receiver)
+        {
+            ::stdexec::set_value(::std::move(_Receiver), ::std::get<2>(_O));
+        }
+        auto _Continue(_Operation& _O) -> bool
+        {
+            if (this->_D_found || ::std::get<2>(_O) == 0u)
+            {
+                return false;
+            }
+            this->_D_buffer.commit(::std::get<2>(_O));
+            return true;
+        }
+        auto _Submit(auto* _Base) -> bool
+        {
+            ::std::string_view _Needle(this->_D_delimiter._D_value);
+            ::std::string_view _View(this->_D_buffer.view());
+            char const*        _End(_View.data() + _View.size());
+            char const*        _Pos(::stdnet::_Hidden::_Search(_View.data() + this->_D_searched, _End, _Needle));
+            if (_Pos != _End || _Needle.empty())
+            {
+                this->_D_found        = true;
+                ::std::get<2>(*_Base) = (_Pos - _View.data()) + _Needle.size();
+                return false;
+            }
+            this->_D_searched = _View.size() - ::std::min(_View.size(), _Needle.size() - 1u);
+
+            ::std::size_t _Room(this->_D_buffer.max_size() - _View.size());
+            if (_Room == 0u)
+            {
+                _Base->_Error(::stdnet::make_error_code(::stdnet::stream_errc::not_found));
+                return true;
+            }
+            // Receive into the space after the data if there is enough of it:
+            // the buffer is only compacted or grown when the tail is too small.
+            ::std::size_t _Tail(this->_D_buffer.tail_capacity());
+            ::stdnet::mutable_buffer _Space(this->_D_buffer.prepare(::std::min(_Room, _Tail < _Receive_size? _Receive_size: _Tail)));
+            this->_D_vec                     = *_Space.data();
+            ::std::get<0>(*_Base).msg_iov    = &this->_D_vec;
+            ::std::get<0>(*_Base).msg_iovlen = 1u;
+            ::std::get<2>(*_Base)            = 0u;
+            ::std::get<3>(*_Base)            = 0u;
+            return this->_D_stream.get_scheduler()._Receive(_Base);
+        }
+    };
+};
+
+// ----------------------------------------------------------------------------
+// async_send_zerocopy(stream, buffers) sends all buffers like
+// async_write_all() but using MSG_ZEROCOPY: the kernel transmits from the
+// buffers' pages instead of copying them into the socket buffer. The
+// operation only completes when the kernel reported that it released all
+// pages, i.e., the buffers can be reused or released once it completed. If
+// the socket doesn't support zero_copy (e.g., it isn't a TCP socket), the
+// buffers are sent normally. The first zero-copy send enables zero_copy on
+// the socket (unless the user already did) and the socket remembers if that
+// failed. The kernel may still copy the data (e.g., over loopback):
+// zero-copy pays off for large sends to real devices.
+//
+// Each sendmsg() with MSG_ZEROCOPY gets acknowledged by a notification on
+// the socket's error queue: the operation does one sendmsg() per submission
+// to count them and reads notifications until all are acknowledged. Only
+// one zero-copy send per socket may be outstanding at a time.
+
+namespace stdnet::_Hidden
+{
+    struct _Zerocopy_state
+    {
+        enum class _Phase { _Start, _Copy, _Send, _Notify };
+
+        _Phase        _D_phase{_Phase::_Start};
+        ::std::size_t _D_size{};
+        ::std::size_t _D_sent{};
+        ::std::size_t _D_calls{};
+        ::std::size_t _D_acknowledged{};
+        alignas(::cmsghdr) char _D_control[128];
+
+        auto _Control(::msghdr& _Msg) -> void
+        {
+            _Msg                = ::msghdr{};
+            _Msg.msg_control    = this->_D_control;
+            _Msg.msg_controllen = sizeof(this->_D_control);
+        }
+        auto _Acknowledge(::msghdr& _Msg) -> void
+        {
+            for (::cmsghdr* _C(CMSG_FIRSTHDR(&_Msg)); _C; _C = CMSG_NXTHDR(&_Msg, _C))
+            {
+                if ((_C->cmsg_level == SOL_IP && _C->cmsg_type == IP_RECVERR)
+                    || (_C->cmsg_level == SOL_IPV6 && _C->cmsg_type == IPV6_RECVERR))
+                {
+                    auto _Error(reinterpret_cast<::sock_extended_err const*>(CMSG_DATA(_C)));
+                    if (_Error->ee_errno == 0 && _Error->ee_origin == SO_EE_ORIGIN_ZEROCOPY)
+                    {
+                        this->_D_acknowledged += _Error->ee_data - _Error->ee_info + 1u;
+                    }
+                }
+            }
+        }
+        // _Drain() picks up the notifications which already arrived: while
+        // any are queued the socket reports an error condition, i.e., the
+        // context would keep waking the operation.
+        auto _Drain(int _Fd) -> void
+        {
+            while (this->_D_acknowledged != this->_D_calls)
+            {
+                ::msghdr _Msg;
+                this->_Control(_Msg);
+                if (::recvmsg(_Fd, &_Msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+                {
+                    return;
+                }
+                this->_Acknowledge(_Msg);
+            }
+        }
+    };
+}
+
+struct stdnet::_Hidden::_Send_zerocopy_desc
+{
+    using _Operation = ::stdnet::_Hidden::_Context_base::_Send_operation;
+    template <typename _Stream_t, typename _Buffers>
+    struct _Data
+    {
+        using _Completion_signature = ::stdexec::set_value_t(::std::size_t);
+        static constexpr bool _Continued{true};
+        using _Phase = ::stdnet::_Hidden::_Zerocopy_state::_Phase;
+
+        _Stream_t&                         _D_stream;
+        ::std::remove_cvref_t<_Buffers>    _D_buffers;
+        ::stdnet::_Hidden::_Zerocopy_state _D_state{};
+
+        auto _Id() const { return this->_D_stream._Id(); }
+        auto _Events() const { return POLLOUT; }
+        auto _Get_scheduler() { return this->_D_stream.get_scheduler(); }
+        auto _Set_value(_Operation&, auto&& _Receiver)
+        {
+            ::stdexec::set_value(::std::move(_Receiver), this->_D_state._D_sent);
+        }
+        auto _Native_handle() -> int
+        {
+            return this->_D_stream.get_scheduler()._Get_context()->_Native_handle(this->_D_stream._Id());
+        }
+        auto _Continue(_Operation& _O) -> bool
+        {
+            auto& _State(this->_D_state);
+            switch (_State._D_phase)
+            {
+            case _Phase::_Start:
+            case _Phase::_Copy:
+                _State._D_sent = ::std::get<2>(_O);
+                return false;
+            case _Phase::_Send:
+                if (::std::size_t _Size = ::std::get<2>(_O))
+                {
+                    ++_State._D_calls;
+                    ::std::get<2>(_O) = _State._D_sent;
+                    ::std::get<3>(_O) = _State._D_size;
+                    bool _More(::stdnet::_Hidden::_Transferred(_O, _Size));
+                    _State._D_sent = ::std::get<2>(_O);
+                    _State._Drain(this->_Native_handle());
+                    if (_More)
+                    {
+                        return true;
+                    }
+                }
+                _State._D_phase = _Phase::_Notify;
+                return _State._D_acknowledged != _State._D_calls;
+            case _Phase::_Notify:
+                _State._Acknowledge(::std::get<0>(_O));
+                _State._Drain(this->_Native_handle());
+                return _State._D_acknowledged != _State._D_calls;
+            }
+            return false;
+        }
+        auto _Submit(auto* _Base) -> bool
+        {
+            auto& _State(this->_D_state);
+            ::msghdr& _Msg(::std::get<0>(*_Base));
+            if (_State._D_phase == _Phase::_Start)
+            {
+                _Msg.msg_iov    = this->_D_buffers.data();
+                _Msg.msg_iovlen = this->_D_buffers.size();
+                _State._D_size  = ::stdnet::_Hidden::_Buffers_size(this->_D_buffers);
+                if (!this->_D_stream._Zero_copy_enabled())
+                {
+                    _State._D_phase       = _Phase::_Copy;
+                    ::std::get<3>(*_Base) = _State._D_size;
+                    return this->_D_stream.get_scheduler()._Send(_Base);
+                }
+                _State._D_phase = _Phase::_Send;
+            }
+            ::std::get<2>(*_Base) = 0u;
+            ::std::get<3>(*_Base) = 0u;
+            if (_State._D_phase == _Phase::_Send)
+            {
+                ::std::get<1>(*_Base) = MSG_ZEROCOPY;
+                return this->_D_stream.get_scheduler()._Send(_Base);
+            }
+            _State._Control(_Msg);
+            ::std::get<1>(*_Base) = MSG_ERRQUEUE;
+            return this->_D_stream.get_scheduler()._Receive(_Base);
+        }
+    };
+};
+
+// ----------------------------------------------------------------------------
+// async_sendfile(stream, file, offset, count) sends count bytes of the file
+// descriptor file starting at offset using sendfile(), i.e., the data isn't
+// copied through user space. Whenever the socket buffer is full the
+// operation waits for writability and continues. It completes with the
+// number of bytes sent which is less than count only if the file or the
+// stream ended. The file isn't owned by the operation and its file offset
+// isn't changed. Like async_send() it accepts an optional timeout.
+
+struct stdnet::_Hidden::_Sendfile_desc
+{
+    using _Operation = ::stdnet::_Hidden::_Context_base::_Sendfile_operation;
+    template <typename _Stream_t, typename _File, typename _Offset, typename _Count, typename... _Timeout>
+    struct _Data
+    {
+        using _Completion_signature = ::stdexec::set_value_t(::std::size_t);
+
+        _Stream_t&                                  _D_stream;
+        ::std::remove_cvref_t<_File>                _D_file;
+        ::std::remove_cvref_t<_Offset>              _D_offset;
+        ::std::remove_cvref_t<_Count>               _D_count;
+        ::stdnet::_Hidden::_Io_timeout<_Timeout...> _D_timeout{};
+
+        auto _Id() const { return this->_D_stream._Id(); }
+        auto _Events() const { return POLLOUT; }
+        auto _Get_scheduler() { return this->_D_stream.get_scheduler(); }
+        auto _Set_value(_Operation& _O, auto&& _Receiver)
+        {
+            ::stdexec::set_value(::std::move(_Receiver), ::std::get<3>(_O));
+        }
+        auto _Submit(auto* _Base) -> bool
+        {
+            ::std::get<0>(*_Base) = int(this->_D_file);
+            ::std::get<1>(*_Base) = ::off_t(this->_D_offset);
+            ::std::get<2>(*_Base) = ::std::size_t(this->_D_count);
+            ::std::get<3>(*_Base) = 0u;
+            this->_D_timeout._Apply(_Base);
+            return this->_D_stream.get_scheduler()._Sendfile(_Base);
+        }
+    };
+};
+
+// ----------------------------------------------------------------------------
+
 enum class stdnet::socket_errc: int
 {
     already_open = 1,
@@ -270,20 +798,23 @@ auto stdnet::socket_category() noexcept -> ::std::error_category const&
 
 // ----------------------------------------------------------------------------
 
-template <typename _AcceptableProtocol>
+// The context type is either the type-erased io_context or a
+// basic_io_context<_Backend>. Accepted sockets use the context's scheduler.
+
+template <typename _AcceptableProtocol, typename _Context>
 class stdnet::basic_socket_acceptor
     : public stdnet::socket_base
 {
 public:
-    using scheduler_type     = ::stdnet::io_context::scheduler_type;
-    using executor_type      = ::stdnet::io_context::executor_type;
+    using scheduler_type     = typename _Context::scheduler_type;
+    using executor_type      = typename _Context::executor_type;
     using native_handle_type = ::stdnet::_Stdnet_native_handle_type;
     using protocol_type      = _AcceptableProtocol;
     using endpoint_type      = typename protocol_type::endpoint;
-    using socket_type        = typename protocol_type::socket;
+    using socket_type        = ::stdnet::basic_stream_socket<protocol_type, scheduler_type>;
 
 private:
-    ::stdnet::io_context&         _D_context;
+    _Context&                     _D_context;
     protocol_type                 _D_protocol; 
     ::stdnet::_Hidden::_Socket_id _D_id{};
 
@@ -300,11 +831,17 @@ private:
     }
 
 public:
-    //explicit basic_socket_acceptor(::stdnet::io_context&);
-    basic_socket_acceptor(::stdnet::io_context&, protocol_type const& protocol);
-    basic_socket_acceptor(::stdnet::io_context& _Context, endpoint_type const& _Endpoint, bool _Reuse = true)
+    //explicit basic_socket_acceptor(_Context&);
+    basic_socket_acceptor(_Context&, protocol_type const& protocol);
+    // With _Reuse_port multiple acceptors (e.g., one per context of an
+    // io_context_pool) can listen on the same endpoint and the kernel
+    // distributes incoming connections between them.
+    basic_socket_acceptor(_Context& _Ctxt,
+                          endpoint_type const& _Endpoint,
+                          bool _Reuse = true,
+                          bool _Reuse_port = false)
         : ::stdnet::socket_base()
-        , _D_context(_Context)
+        , _D_context(_Ctxt)
         , _D_protocol(_Endpoint.protocol())
         , _D_id(::stdnet::_Hidden::_Socket_id::_Invalid)
     {
@@ -313,13 +850,18 @@ public:
         {
             this->set_option(::stdnet::socket_base::reuse_address(true));
         }
+        if (_Reuse_port)
+        {
+            this->set_option(::stdnet::socket_base::reuse_port(true));
+        }
         this->bind(_Endpoint);
         this->listen();
     }
-    basic_socket_acceptor(::stdnet::io_context&, protocol_type const&, native_handle_type const&);
+    basic_socket_acceptor(_Context&, protocol_type const&, native_handle_type const&);
     basic_socket_acceptor(basic_socket_acceptor const&) = delete;
     basic_socket_acceptor(basic_socket_acceptor&& _Other)
         : ::stdnet::socket_base()
+        , _D_context(_Other._D_context)
         , _D_protocol(_Other._D_protocol)
         , _D_id(::std::exchange(_Other._D_id, ::stdnet::_Hidden::_Socket_id::_Invalid))
     {
@@ -339,7 +881,7 @@ public:
     template<typename _OtherProtocol>
     basic_socket_acceptor& operator=(::stdnet::basic_socket_acceptor<_OtherProtocol>&&);
 
-    auto _Get_context() -> ::stdnet::io_context& { return this->_D_context; }
+    auto _Get_context() -> _Context& { return this->_D_context; }
     auto get_scheduler() noexcept -> scheduler_type
     {
         return this->_D_context.get_scheduler();
@@ -369,13 +911,14 @@ public:
     {
         _Dispatch([this](auto& _Error){ return this->close(_Error); });
     }
+    // Releasing the socket cancels the outstanding operations: they complete
+    // with set_stopped().
     auto close(::std::error_code& _Error) -> void
     {
-        //-dk:TODO cancel outstanding work
         if (this->is_open())
         {
-            this->_D_context._Release(this->_Id(), _Error);
-            }
+            this->_D_context._Release(::std::exchange(this->_D_id, ::stdnet::_Hidden::_Socket_id::_Invalid), _Error);
+        }
     }
     void cancel();
     void cancel(::std::error_code&);
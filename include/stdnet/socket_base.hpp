@@ -58,8 +58,34 @@ public:
         explicit reuse_address(bool _Value): _Socket_option(_Value) {}
         explicit operator bool() const { return this->_Value(); }
     };
+    class reuse_port
+        : public _Socket_option<int, SOL_SOCKET, SO_REUSEPORT>
+    {
+    public:
+        explicit reuse_port(bool _Value): _Socket_option(_Value) {}
+        explicit operator bool() const { return this->_Value(); }
+    };
     class send_buffer_size;
     class send_low_watermark;
+    // With zero_copy enabled, sends using MSG_ZEROCOPY (see
+    // async_send_zerocopy()) transmit from the user's pages.
+    class zero_copy
+        : public _Socket_option<int, SOL_SOCKET, SO_ZEROCOPY>
+    {
+    public:
+        explicit zero_copy(bool _Value): _Socket_option(_Value) {}
+        explicit operator bool() const { return this->_Value(); }
+    };
+    // With speculative_io enabled, receive, send, and accept operations are
+    // tried when they are started and only wait for readiness if they would
+    // block. Enabling it makes the socket non-blocking.
+    class speculative_io
+        : public _Socket_option<int, ::stdnet::_Hidden::_Stdnet_option_level, ::stdnet::_Hidden::_Speculative_io_option>
+    {
+    public:
+        explicit speculative_io(bool _Value): _Socket_option(_Value) {}
+        explicit operator bool() const { return this->_Value(); }
+    };
 
     using shutdown_type = int; //-dk:TODO
     static constexpr shutdown_type shutdown_receive{1};
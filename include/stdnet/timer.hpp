@@ -21,7 +21,11 @@
 #define INCLUDED_STDNET_TIMER
 
 #include <stdnet/netfwd.hpp>
+#include <stdnet/context_base.hpp>
 #include <stdnet/cpo.hpp>
+#include <chrono>
+#include <concepts>
+#include <type_traits>
 
 // ----------------------------------------------------------------------------
 
@@ -40,18 +44,78 @@ namespace stdnet
     inline constexpr async_resume_at_t    async_resume_at{};
 }
 
+// ----------------------------------------------------------------------------
+// Timers are based on steady_clock. Deadlines using other clocks are converted
+// when the timer is started.
+
+namespace stdnet::_Hidden
+{
+    template <typename _Clock, typename _Duration>
+    auto _To_steady(::std::chrono::time_point<_Clock, _Duration> const& _Time)
+        -> ::std::chrono::steady_clock::time_point
+    {
+        using _Steady = ::std::chrono::steady_clock;
+        if constexpr (::std::same_as<_Clock, _Steady>)
+        {
+            return ::std::chrono::ceil<_Steady::duration>(_Time);
+        }
+        else
+        {
+            return _Steady::now() + ::std::chrono::ceil<_Steady::duration>(_Time - _Clock::now());
+        }
+    }
+
+    template <typename...> struct _Io_timeout;
+}
+
+// ----------------------------------------------------------------------------
+// _Io_timeout holds the optional trailing timeout argument of socket
+// operations: either a duration relative to the start of the operation or a
+// time_point. When the operation is submitted the deadline is attached to
+// the operation; a duration is only turned into a time_point by the context
+// using its cached time. Without a timeout argument nothing is stored.
+
+template <>
+struct stdnet::_Hidden::_Io_timeout<>
+{
+    auto _Apply(::stdnet::_Hidden::_Io_base*) -> void {}
+};
+
+template <typename _Timeout>
+struct stdnet::_Hidden::_Io_timeout<_Timeout>
+{
+    ::std::remove_cvref_t<_Timeout> _D_timeout;
+    ::stdnet::_Hidden::_Io_deadline _D_deadline{};
+
+    auto _Apply(::stdnet::_Hidden::_Io_base* _Base) -> void
+    {
+        using _Steady = ::std::chrono::steady_clock;
+        if constexpr (requires{ typename ::std::remove_cvref_t<_Timeout>::clock; })
+        {
+            this->_D_deadline._Time     = ::stdnet::_Hidden::_To_steady(this->_D_timeout);
+            this->_D_deadline._Relative = false;
+        }
+        else
+        {
+            this->_D_deadline._Timeout  = ::std::chrono::ceil<_Steady::duration>(this->_D_timeout);
+            this->_D_deadline._Relative = true;
+        }
+        _Base->_Deadline = &this->_D_deadline;
+    }
+};
+
 // ----------------------------------------------------------------------------
 
 struct stdnet::_Hidden::_Resume_after_desc
 {
     using _Operation = ::stdnet::_Hidden::_Context_base::_Resume_after_operation;
-    template <typename _Scheduler, typename>
+    template <typename _Scheduler, typename _Duration>
     struct _Data
     {
         using _Completion_signature = ::stdexec::set_value_t();
 
         ::std::remove_cvref_t<_Scheduler> _D_scheduler;
-        ::std::chrono::microseconds       _D_duration;
+        ::std::remove_cvref_t<_Duration>  _D_duration;
 
         auto _Id() const -> ::stdnet::_Hidden::_Socket_id { return {}; }
         auto _Events() const { return decltype(POLLIN)(); }
@@ -62,7 +126,7 @@ struct stdnet::_Hidden::_Resume_after_desc
         }
         auto _Submit(auto* _Base) -> bool
         {
-            ::std::get<0>(*_Base) = this->_D_duration;
+            ::std::get<0>(*_Base) = ::std::chrono::ceil<::std::chrono::nanoseconds>(this->_D_duration);
             return this->_D_scheduler._Resume_after(_Base);
         }
     };
@@ -73,13 +137,13 @@ struct stdnet::_Hidden::_Resume_after_desc
 struct stdnet::_Hidden::_Resume_at_desc
 {
     using _Operation = ::stdnet::_Hidden::_Context_base::_Resume_at_operation;
-    template <typename _Scheduler, typename>
+    template <typename _Scheduler, typename _Time>
     struct _Data
     {
         using _Completion_signature = ::stdexec::set_value_t();
 
-        ::std::remove_cvref_t<_Scheduler>       _D_scheduler;
-        ::std::chrono::system_clock::time_point _D_time;
+        ::std::remove_cvref_t<_Scheduler> _D_scheduler;
+        ::std::remove_cvref_t<_Time>      _D_time;
 
         auto _Id() const -> ::stdnet::_Hidden::_Socket_id { return {}; }
         auto _Events() const { return decltype(POLLIN)(); }
@@ -90,7 +154,7 @@ struct stdnet::_Hidden::_Resume_at_desc
         }
         auto _Submit(auto* _Base) -> bool
         {
-            ::std::get<0>(*_Base) = this->_D_time;
+            ::std::get<0>(*_Base) = ::stdnet::_Hidden::_To_steady(this->_D_time);
             return this->_D_scheduler._Resume_at(_Base);
         }
     };
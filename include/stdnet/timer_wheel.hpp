@@ -0,0 +1,233 @@
+// stdnet/timer_wheel.hpp                                             -*-C++-*-
+// ----------------------------------------------------------------------------
+/*
+ * Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_STDNET_TIMER_WHEEL
+#define INCLUDED_STDNET_TIMER_WHEEL
+
+#include <stdnet/netfwd.hpp>
+#include <stdnet/io_base.hpp>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// ----------------------------------------------------------------------------
+
+namespace stdnet::_Hidden
+{
+    struct _Timer_node;
+    class _Timer_wheel;
+}
+
+// ----------------------------------------------------------------------------
+// The struct _Timer_node links a timer operation into a _Timer_wheel. Nodes
+// are constructed in the _Timer_storage of the timer operations, i.e., arming
+// a timer doesn't allocate.
+
+struct stdnet::_Hidden::_Timer_node
+{
+    _Timer_node*                 _Next{this};
+    _Timer_node*                 _Prev{this};
+    ::stdnet::_Hidden::_Io_base* _Op{nullptr};
+    ::std::uint64_t              _Expiry{};
+    unsigned                     _Slot{};
+
+    _Timer_node() = default;
+    _Timer_node(_Timer_node&&) = delete;
+
+    auto _Linked() const -> bool { return this->_Next != this; }
+    auto _Unlink() -> void
+    {
+        this->_Prev->_Next = this->_Next;
+        this->_Next->_Prev = this->_Prev;
+        this->_Next = this->_Prev = this;
+    }
+};
+
+// ----------------------------------------------------------------------------
+// The class _Timer_wheel is a hierarchical timing wheel with a resolution of
+// one millisecond: level _L has _Slots slots each covering _Slots^_L ticks.
+// Inserting and erasing a timer are O(1). Timers on the higher levels are
+// moved to lower levels when the time reaches their slot. Timers further in
+// the future than the wheel covers are kept in the last slot reached and
+// reinserted when that slot is cascaded.
+
+class stdnet::_Hidden::_Timer_wheel
+{
+public:
+    using _Clock = ::std::chrono::steady_clock;
+    using _Tick  = ::std::chrono::milliseconds;
+
+private:
+    static constexpr unsigned        _Bits{6u};
+    static constexpr unsigned        _Slots{1u << _Bits};
+    static constexpr unsigned        _Levels{4u};
+    static constexpr ::std::uint64_t _Mask{_Slots - 1u};
+    static constexpr ::std::uint64_t _Range{::std::uint64_t(1u) << (_Levels * _Bits)};
+
+    _Clock::time_point             _D_base{_Clock::now()};
+    ::std::uint64_t                _D_now{};    // the next tick to be processed
+    ::std::size_t                  _D_size{};
+    ::std::uint64_t                _D_occupied[_Levels]{};
+    ::stdnet::_Hidden::_Timer_node _D_slots[_Levels * _Slots];
+
+    auto _Link(::stdnet::_Hidden::_Timer_node* _Node) -> void
+    {
+        ::std::uint64_t _Delta(::std::min(_Node->_Expiry - this->_D_now, _Range - 1u));
+        ::std::uint64_t _When(this->_D_now + _Delta);
+        unsigned        _Level{};
+        while (_Level + 1u != _Levels && (::std::uint64_t(1u) << ((_Level + 1u) * _Bits)) <= _Delta)
+        {
+            ++_Level;
+        }
+        unsigned _Index((_When >> (_Level * _Bits)) & _Mask);
+        ::stdnet::_Hidden::_Timer_node& _Head(this->_D_slots[_Level * _Slots + _Index]);
+        _Node->_Slot = _Level * _Slots + _Index;
+        _Node->_Next = &_Head;
+        _Node->_Prev = _Head._Prev;
+        _Head._Prev->_Next = _Node;
+        _Head._Prev = _Node;
+        this->_D_occupied[_Level] |= ::std::uint64_t(1u) << _Index;
+    }
+    auto _Remove(::stdnet::_Hidden::_Timer_node* _Node) -> void
+    {
+        unsigned _Slot(_Node->_Slot);
+        _Node->_Unlink();
+        if (!this->_D_slots[_Slot]._Linked())
+        {
+            this->_D_occupied[_Slot / _Slots] &= ~(::std::uint64_t(1u) << (_Slot % _Slots));
+        }
+    }
+    auto _Cascade(unsigned _Level, unsigned _Index) -> void
+    {
+        ::stdnet::_Hidden::_Timer_node& _Head(this->_D_slots[_Level * _Slots + _Index]);
+        while (_Head._Linked())
+        {
+            ::stdnet::_Hidden::_Timer_node* _Node(_Head._Next);
+            this->_Remove(_Node);
+            this->_Link(_Node);
+        }
+    }
+
+public:
+    _Timer_wheel() = default;
+    _Timer_wheel(_Timer_wheel&&) = delete;
+
+    auto _Empty() const -> bool { return this->_D_size == 0u; }
+    auto _Size() const -> ::std::size_t { return this->_D_size; }
+
+    // _Insert() arms a timer expiring at _Time. Timers never expire early
+    // but may expire up to one tick late.
+    auto _Insert(::stdnet::_Hidden::_Timer_node* _Node, _Clock::time_point _Time) -> void
+    {
+        auto _Ticks(::std::chrono::ceil<_Tick>(_Time - this->_D_base).count());
+        _Node->_Expiry = ::std::max(this->_D_now, ::std::uint64_t(::std::max(_Ticks, decltype(_Ticks)())));
+        this->_Link(_Node);
+        ++this->_D_size;
+    }
+    // _Erase() disarms a timer and returns false if it wasn't armed.
+    auto _Erase(::stdnet::_Hidden::_Timer_node* _Node) -> bool
+    {
+        if (!_Node->_Linked())
+        {
+            return false;
+        }
+        this->_Remove(_Node);
+        --this->_D_size;
+        return true;
+    }
+
+    // _Next() returns a time no later than the first expiry of an armed
+    // timer or time_point::max() if there is none. The time may be earlier
+    // when timers need to be moved to a lower level first but it is never
+    // before the next tick to be processed. Once the time passed the start
+    // of a block on a higher level, the slot of that block was cascaded
+    // already: timers in this slot are moved when the wheel comes around.
+    auto _Next() const -> _Clock::time_point
+    {
+        if (this->_D_size == 0u)
+        {
+            return _Clock::time_point::max();
+        }
+        ::std::uint64_t _First(::std::numeric_limits<::std::uint64_t>::max());
+        for (unsigned _Level{}; _Level != _Levels; ++_Level)
+        {
+            if (this->_D_occupied[_Level])
+            {
+                unsigned        _Shift(_Level * _Bits);
+                bool            _Started((this->_D_now & ((::std::uint64_t(1u) << _Shift) - 1u)) != 0u);
+                ::std::uint64_t _Block((this->_D_now >> _Shift) + _Started);
+                int             _Ahead(::std::countr_zero(::std::rotr(this->_D_occupied[_Level], int(_Block & _Mask))));
+                _First = ::std::min(_First, _Level == 0u? this->_D_now + _Ahead: (_Block + _Ahead) << _Shift);
+            }
+        }
+        return this->_D_base + _Tick(_First);
+    }
+
+    // _Expire() removes all timers expired at time _Now and calls _Fun with
+    // the corresponding operation for each of them.
+    template <typename _Fun>
+    auto _Expire(_Clock::time_point _Now, _Fun _F) -> void
+    {
+        auto _Ticks(::std::chrono::floor<_Tick>(_Now - this->_D_base).count());
+        if (_Ticks < 0)
+        {
+            return;
+        }
+        ::std::uint64_t _Target(_Ticks);
+        while (this->_D_now <= _Target)
+        {
+            if (this->_D_size == 0u)
+            {
+                this->_D_now = _Target + 1u;
+                break;
+            }
+            unsigned _Index(this->_D_now & _Mask);
+            if (_Index != 0u && this->_D_occupied[0] == 0u)
+            {
+                // Nothing can happen before the next block starts.
+                this->_D_now = ::std::min(_Target + 1u, (this->_D_now | _Mask) + 1u);
+                continue;
+            }
+            for (unsigned _Level(1u); _Level != _Levels; ++_Level)
+            {
+                if ((this->_D_now & ((::std::uint64_t(1u) << (_Level * _Bits)) - 1u)) != 0u)
+                {
+                    break;
+                }
+                this->_Cascade(_Level, (this->_D_now >> (_Level * _Bits)) & _Mask);
+            }
+            ::stdnet::_Hidden::_Timer_node& _Head(this->_D_slots[_Index]);
+            while (_Head._Linked())
+            {
+                ::stdnet::_Hidden::_Timer_node* _Node(_Head._Next);
+                this->_Remove(_Node);
+                --this->_D_size;
+                _F(_Node->_Op);
+            }
+            ++this->_D_now;
+        }
+    }
+};
+
+// ----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,1023 @@
+// stdnet/uring_context.hpp                                           -*-C++-*-
+// ----------------------------------------------------------------------------
+/*
+ * Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// ----------------------------------------------------------------------------
+
+#ifndef INCLUDED_STDNET_URING_CONTEXT
+#define INCLUDED_STDNET_URING_CONTEXT
+
+#include <stdnet/netfwd.hpp>
+#include <stdnet/container.hpp>
+#include <stdnet/context_base.hpp>
+#include <stdnet/event_fd.hpp>
+#include <stdnet/io_work.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <csignal>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <cerrno>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+
+namespace stdnet::_Hidden
+{
+    struct _Uring_record;
+    class _Uring_context;
+}
+
+// ----------------------------------------------------------------------------
+
+struct stdnet::_Hidden::_Uring_record final
+{
+    bool                                                   _Blocking{true};
+    bool                                                   _Speculative{false};
+};
+
+// ----------------------------------------------------------------------------
+// The _Uring_context is a completion based context: the operations are
+// turned into submission queue entries which are only handed to the kernel
+// when run_one() needs to wait for completions, i.e., all operations started
+// while processing completions are submitted with one system call. The
+// user_data of each entry is the _Io_base* of the operation and the _Work
+// function is called with the result of the completion stored in _D_result
+// and its flags in _D_flags: a multishot operation stays outstanding as long
+// as its completions carry IORING_CQE_F_MORE.
+// Entries with user_data 0 (e.g., cancellation requests) don't have an
+// associated operation. The read of the (blocking) wakeup descriptor uses
+// user_data 1 and the timeouts linked to operations with a deadline use
+// user_data 2: the outcome of these is reported via the linked operation.
+
+class stdnet::_Hidden::_Uring_context final
+    : public ::stdnet::_Hidden::_Context_base
+{
+private:
+    // basic_io_context<_Uring_context> calls the functions directly.
+    template <typename> friend class ::stdnet::basic_io_context;
+    template <typename> friend class ::stdnet::_Hidden::_Static_scheduler;
+
+    struct _Mapping
+    {
+        void*         _Address{MAP_FAILED};
+        ::std::size_t _Size{};
+        ~_Mapping() { if (this->_Address != MAP_FAILED) ::munmap(this->_Address, this->_Size); }
+    };
+
+    ::stdnet::_Hidden::_Container<::stdnet::_Hidden::_Uring_record> _D_sockets;
+    int                      _D_fd{-1};
+    _Mapping                 _D_ring;
+    _Mapping                 _D_completion_ring;
+    _Mapping                 _D_entries;
+    unsigned*                _D_sq_head{};
+    unsigned*                _D_sq_tail{};
+    unsigned                 _D_sq_mask{};
+    unsigned*                _D_sq_array{};
+    ::io_uring_sqe*          _D_sqes{};
+    unsigned*                _D_cq_head{};
+    unsigned*                _D_cq_tail{};
+    unsigned                 _D_cq_mask{};
+    ::io_uring_cqe*          _D_cqes{};
+    unsigned                 _D_sq_entries{};
+    unsigned                 _D_unsubmitted{};
+    ::std::size_t            _D_outstanding{};
+    int                      _D_result{};
+    unsigned                 _D_flags{};
+    ::std::size_t            _D_provided{};
+    bool                     _D_multishot_accept{};
+    bool                     _D_multishot_receive{};
+    ::stdnet::_Hidden::_Speculation _D_speculation;
+    ::stdnet::_Hidden::_Event_fd    _D_wakeup{EFD_CLOEXEC};
+    ::std::uint64_t                 _D_wakeup_value{};
+
+    static constexpr ::std::uint64_t _Wakeup_tag{1u};
+    static constexpr ::std::uint64_t _Timeout_tag{2u}; // or-ed into the operation's address
+
+    // A socket operation with a deadline has a linked timeout which lives in
+    // the deadline storage. The operation is processed once the completions
+    // of both entries arrived: the result of the timeout tells whether it
+    // fired and the storage isn't released while the kernel still uses it.
+    struct _Linked_timeout
+    {
+        ::__kernel_timespec _Time{};
+        int                 _Result{};
+        unsigned            _Flags{};
+        unsigned            _Pending{2u};
+        bool                _Fired{false};
+    };
+
+    auto _Make_socket(int, bool) -> ::stdnet::_Hidden::_Socket_id override;
+    auto _Make_socket(int, int, int, ::std::error_code&) -> ::stdnet::_Hidden::_Socket_id override;
+    auto _Release(::stdnet::_Hidden::_Socket_id, ::std::error_code&) -> void override;
+    auto _Native_handle(::stdnet::_Hidden::_Socket_id) -> _Stdnet_native_handle_type override;
+    auto _Set_option(::stdnet::_Hidden::_Socket_id, int, int, void const*, ::socklen_t, ::std::error_code&) -> void override;
+    auto _Bind(::stdnet::_Hidden::_Socket_id, ::stdnet::_Hidden::_Endpoint const&, ::std::error_code&) -> void override;
+    auto _Listen(::stdnet::_Hidden::_Socket_id, int, ::std::error_code&) -> void override;
+
+    auto run_one() -> ::std::size_t override;
+    auto _Run_some(::std::size_t, ::std::chrono::steady_clock::time_point) -> ::std::size_t override;
+    auto _Wakeup() -> void override;
+
+    auto _Cancel(::stdnet::_Hidden::_Cancel_node*) -> void override;
+    auto _Accept(::stdnet::_Hidden::_Context_base::_Accept_operation*) -> bool override;
+    auto _Accept_multishot(::stdnet::_Hidden::_Context_base::_Accept_operation*) -> bool override;
+    auto _Connect(::stdnet::_Hidden::_Context_base::_Connect_operation*) -> bool override;
+    auto _Receive(::stdnet::_Hidden::_Context_base::_Receive_operation*) -> bool override;
+    auto _Receive_multishot(::stdnet::_Hidden::_Context_base::_Receive_multishot_operation*) -> bool override;
+    auto _Send(::stdnet::_Hidden::_Context_base::_Send_operation*) -> bool override;
+    auto _Sendfile(::stdnet::_Hidden::_Context_base::_Sendfile_operation*) -> bool override;
+    auto _Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation*) -> bool override;
+    auto _Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation*) -> bool override;
+
+    auto _Probe() -> void;
+    auto _Enter(unsigned, unsigned, ::io_uring_getevents_arg* = nullptr) -> int;
+    auto _Wait(::std::chrono::steady_clock::time_point) -> int;
+    auto _Read_wakeup() -> void;
+    auto _Reserve(unsigned) -> void;
+    auto _Get_sqe(::std::uint8_t, int, ::stdnet::_Hidden::_Io_base*) -> ::io_uring_sqe*;
+    auto _Get_io_sqe(::std::uint8_t, ::stdnet::_Hidden::_Io_base*) -> ::io_uring_sqe*;
+    auto _Linked(::stdnet::_Hidden::_Io_base*, bool) -> bool;
+    auto _Prepare_timer(::stdnet::_Hidden::_Io_base*, _Timer_storage&) -> ::__kernel_timespec&;
+    auto _Provide_buffers() -> void;
+    auto _Provide(::stdnet::_Hidden::_Receive_pool::_Index) -> void;
+    auto _Accept_failed(::stdnet::_Hidden::_Context_base::_Accept_operation*, int) -> void;
+
+    template <typename _Operation, auto _Start = nullptr>
+    static auto _Result(::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op) -> bool;
+
+public:
+    _Uring_context(unsigned = 256u);
+    _Uring_context(_Uring_context&&) = delete;
+    ~_Uring_context();
+};
+
+// ----------------------------------------------------------------------------
+
+inline stdnet::_Hidden::_Uring_context::_Uring_context(unsigned _Entries)
+{
+    ::io_uring_params _Params{};
+    this->_D_fd = int(::syscall(__NR_io_uring_setup, _Entries, &_Params));
+    if (this->_D_fd < 0)
+    {
+        throw ::std::system_error(::std::error_code(errno, ::std::system_category()));
+    }
+    // Waiting with a timeout needs IORING_ENTER_EXT_ARG (Linux 5.11).
+    if (!(_Params.features & IORING_FEAT_EXT_ARG))
+    {
+        ::close(this->_D_fd);
+        throw ::std::system_error(::std::make_error_code(::std::errc::function_not_supported),
+                                  "io_uring doesn't support IORING_FEAT_EXT_ARG");
+    }
+    this->_Probe();
+
+    this->_D_ring._Size = _Params.sq_off.array + _Params.sq_entries * sizeof(unsigned);
+    this->_D_completion_ring._Size = _Params.cq_off.cqes + _Params.cq_entries * sizeof(::io_uring_cqe);
+    bool _Single(_Params.features & IORING_FEAT_SINGLE_MMAP);
+    if (_Single)
+    {
+        this->_D_ring._Size = ::std::max(this->_D_ring._Size, this->_D_completion_ring._Size);
+    }
+    this->_D_ring._Address = ::mmap(nullptr, this->_D_ring._Size, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, this->_D_fd, IORING_OFF_SQ_RING);
+    void* _Completion(this->_D_ring._Address);
+    if (!_Single && this->_D_ring._Address != MAP_FAILED)
+    {
+        this->_D_completion_ring._Address = ::mmap(nullptr, this->_D_completion_ring._Size, PROT_READ | PROT_WRITE,
+                                                   MAP_SHARED | MAP_POPULATE, this->_D_fd, IORING_OFF_CQ_RING);
+        _Completion = this->_D_completion_ring._Address;
+    }
+    this->_D_entries._Size = _Params.sq_entries * sizeof(::io_uring_sqe);
+    this->_D_entries._Address = ::mmap(nullptr, this->_D_entries._Size, PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_POPULATE, this->_D_fd, IORING_OFF_SQES);
+    if (this->_D_ring._Address == MAP_FAILED
+        || _Completion == MAP_FAILED
+        || this->_D_entries._Address == MAP_FAILED)
+    {
+        int _Errno(errno);
+        ::close(this->_D_fd);
+        throw ::std::system_error(::std::error_code(_Errno, ::std::system_category()));
+    }
+
+    char* _Sq(static_cast<char*>(this->_D_ring._Address));
+    this->_D_sq_head    = reinterpret_cast<unsigned*>(_Sq + _Params.sq_off.head);
+    this->_D_sq_tail    = reinterpret_cast<unsigned*>(_Sq + _Params.sq_off.tail);
+    this->_D_sq_mask    = *reinterpret_cast<unsigned*>(_Sq + _Params.sq_off.ring_mask);
+    this->_D_sq_array   = reinterpret_cast<unsigned*>(_Sq + _Params.sq_off.array);
+    this->_D_sq_entries = _Params.sq_entries;
+    this->_D_sqes       = static_cast<::io_uring_sqe*>(this->_D_entries._Address);
+
+    char* _Cq(static_cast<char*>(_Completion));
+    this->_D_cq_head = reinterpret_cast<unsigned*>(_Cq + _Params.cq_off.head);
+    this->_D_cq_tail = reinterpret_cast<unsigned*>(_Cq + _Params.cq_off.tail);
+    this->_D_cq_mask = *reinterpret_cast<unsigned*>(_Cq + _Params.cq_off.ring_mask);
+    this->_D_cqes    = reinterpret_cast<::io_uring_cqe*>(_Cq + _Params.cq_off.cqes);
+
+    this->_Read_wakeup();
+}
+
+inline stdnet::_Hidden::_Uring_context::~_Uring_context()
+{
+    ::close(this->_D_fd);
+}
+
+// The multishot operations are optional: they fail with
+// operation_not_supported if the kernel can't do them. There is no probe
+// for the multishot flags: they were added together with operations which
+// can be probed (multishot accept with IORING_OP_SOCKET in Linux 5.19,
+// multishot receive with IORING_OP_SEND_ZC in Linux 6.0).
+
+inline auto stdnet::_Hidden::_Uring_context::_Probe() -> void
+{
+    constexpr unsigned _Ops{256u};
+    alignas(::io_uring_probe) unsigned char _Buffer[sizeof(::io_uring_probe) + _Ops * sizeof(::io_uring_probe_op)]{};
+    auto _Probe(reinterpret_cast<::io_uring_probe*>(_Buffer));
+    if (::syscall(__NR_io_uring_register, this->_D_fd, IORING_REGISTER_PROBE, _Probe, _Ops) < 0)
+    {
+        return;
+    }
+    auto _Supported = [_Probe](unsigned _Op){
+        return _Op <= _Probe->last_op && (_Probe->ops[_Op].flags & IO_URING_OP_SUPPORTED);
+    };
+    this->_D_multishot_accept  = _Supported(IORING_OP_SOCKET);
+    this->_D_multishot_receive = _Supported(IORING_OP_SEND_ZC) && _Supported(IORING_OP_PROVIDE_BUFFERS);
+}
+
+// ----------------------------------------------------------------------------
+
+inline auto stdnet::_Hidden::_Uring_context::_Make_socket(int _Fd, bool _Blocking) -> ::stdnet::_Hidden::_Socket_id
+{
+    auto _Id(this->_D_sockets._Insert(_Fd));
+    this->_D_sockets[_Id]._Blocking = _Blocking;
+    return _Id;
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Make_socket(int _D, int _T, int _P, ::std::error_code& _Error)
+    -> ::stdnet::_Hidden::_Socket_id
+{
+    int _Fd(::socket(_D, _T, _P));
+    if (_Fd < 0)
+    {
+        _Error = ::std::error_code(errno, ::std::system_category());
+        return ::stdnet::_Hidden::_Socket_id::_Invalid;
+    }
+    return this->_Make_socket(_Fd, true);
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Release(::stdnet::_Hidden::_Socket_id _Id, ::std::error_code& _Error) -> void
+{
+    if (!this->_D_sockets._Valid(_Id))
+    {
+        _Error = ::std::error_code(EBADF, ::std::system_category());
+        return;
+    }
+    _Stdnet_native_handle_type _Handle(this->_D_sockets._Handle(_Id));
+    // In-flight operations keep a reference to the file: they are cancelled
+    // explicitly and complete with ECANCELED. The pending entries need to be
+    // submitted before the descriptor is closed.
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_ASYNC_CANCEL, _Handle, nullptr));
+    _Sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    this->_Enter(0u, 0u);
+    this->_D_sockets._Erase(_Id);
+    if (::close(_Handle) < 0)
+    {
+        _Error = ::std::error_code(errno, ::std::system_category());
+    }
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Native_handle(::stdnet::_Hidden::_Socket_id _Id) -> _Stdnet_native_handle_type
+{
+    return this->_D_sockets._Handle(_Id);
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Set_option(::stdnet::_Hidden::_Socket_id _Id,
+                                                      int                           _Level,
+                                                      int                           _Name,
+                                                      void const*                   _Data,
+                                                      ::socklen_t                   _Size,
+                                                      ::std::error_code&            _Error)
+    -> void
+{
+    if (_Level == ::stdnet::_Hidden::_Stdnet_option_level && _Name == ::stdnet::_Hidden::_Speculative_io_option)
+    {
+        ::stdnet::_Hidden::_Set_speculative(this->_D_sockets[_Id], this->_D_sockets._Handle(_Id), _Data, _Size, _Error);
+        return;
+    }
+    if (::setsockopt(this->_Native_handle(_Id), _Level, _Name, _Data, _Size) < 0)
+    {
+        _Error = ::std::error_code(errno, ::std::system_category());
+    }
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Bind(::stdnet::_Hidden::_Socket_id _Id,
+                                                ::stdnet::_Hidden::_Endpoint const& _Endpoint,
+                                                ::std::error_code& _Error)
+            -> void
+{
+    if (::bind(this->_Native_handle(_Id), _Endpoint._Data(), _Endpoint._Size()) < 0)
+    {
+        _Error = ::std::error_code(errno, ::std::system_category());
+    }
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Listen(::stdnet::_Hidden::_Socket_id _Id,
+                                                  int                           _No,
+                                                  ::std::error_code&            _Error)
+    -> void
+{
+    if (::listen(this->_Native_handle(_Id), _No) < 0)
+    {
+        _Error = ::std::error_code(errno, ::std::system_category());
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline auto stdnet::_Hidden::_Uring_context::_Enter(unsigned _Min_complete, unsigned _Flags, ::io_uring_getevents_arg* _Arg)
+    -> int
+{
+    while (true)
+    {
+        int _Rc(int(::syscall(__NR_io_uring_enter, this->_D_fd, this->_D_unsubmitted, _Min_complete, _Flags,
+                              _Arg, _Arg? sizeof(*_Arg): 0u)));
+        if (0 <= _Rc)
+        {
+            this->_D_unsubmitted -= ::std::min(this->_D_unsubmitted, unsigned(_Rc));
+            return _Rc;
+        }
+        if (errno != EINTR)
+        {
+            return _Rc;
+        }
+    }
+}
+
+// _Reserve() makes sure the next _Count entries fit into the submission queue
+// such that they are handed to the kernel together.
+
+inline auto stdnet::_Hidden::_Uring_context::_Reserve(unsigned _Count) -> void
+{
+    unsigned _Tail(*this->_D_sq_tail);
+    while (this->_D_sq_entries - _Count
+           < _Tail - ::std::atomic_ref<unsigned>(*this->_D_sq_head).load(::std::memory_order_acquire))
+    {
+        this->_Enter(0u, 0u);
+    }
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Get_sqe(::std::uint8_t _Opcode, int _Fd, ::stdnet::_Hidden::_Io_base* _Op)
+    -> ::io_uring_sqe*
+{
+    this->_Reserve(1u);
+    unsigned _Tail(*this->_D_sq_tail);
+    unsigned _Index(_Tail & this->_D_sq_mask);
+    ::io_uring_sqe* _Sqe(this->_D_sqes + _Index);
+    ::std::memset(_Sqe, 0, sizeof(*_Sqe));
+    _Sqe->opcode    = _Opcode;
+    _Sqe->fd        = _Fd;
+    _Sqe->user_data = reinterpret_cast<::std::uintptr_t>(_Op);
+    this->_D_sq_array[_Index] = _Index;
+    ::std::atomic_ref<unsigned>(*this->_D_sq_tail).store(_Tail + 1u, ::std::memory_order_release);
+    ++this->_D_unsubmitted;
+    if (_Op)
+    {
+        _Op->_Context = this;
+        ++this->_D_outstanding;
+    }
+    return _Sqe;
+}
+
+// _Get_io_sqe() gets the entry for a socket operation. If the operation has
+// a deadline, a linked timeout with the absolute deadline is added after the
+// entry (the caller fills the entry in before anything is submitted): when
+// the timeout fires the operation completes with ECANCELED and the timeout
+// with ETIME.
+
+inline auto stdnet::_Hidden::_Uring_context::_Get_io_sqe(::std::uint8_t _Opcode, ::stdnet::_Hidden::_Io_base* _Op)
+    -> ::io_uring_sqe*
+{
+    if (!_Op->_Deadline)
+    {
+        return this->_Get_sqe(_Opcode, this->_Native_handle(_Op->_Id), _Op);
+    }
+
+    static_assert(sizeof(::__kernel_timespec) <= sizeof(_Timer_storage));
+    this->_Reserve(2u);
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(_Opcode, this->_Native_handle(_Op->_Id), _Op));
+    _Sqe->flags |= IOSQE_IO_LINK;
+
+    static_assert(sizeof(_Linked_timeout) <= sizeof(_Timer_storage));
+    auto _Time(_Op->_Deadline->_Resolve(this->_Now()).time_since_epoch());
+    auto& _Link(*::new(static_cast<void*>(_Op->_Deadline->_Storage._Data)) _Linked_timeout{});
+    _Link._Time.tv_sec  = ::std::chrono::duration_cast<::std::chrono::seconds>(_Time).count();
+    _Link._Time.tv_nsec = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(_Time % ::std::chrono::seconds(1)).count();
+    ::io_uring_sqe* _Timeout(this->_Get_sqe(IORING_OP_LINK_TIMEOUT, -1, _Op));
+    _Timeout->addr          = reinterpret_cast<::std::uintptr_t>(&_Link._Time);
+    _Timeout->len           = 1u;
+    _Timeout->timeout_flags = IORING_TIMEOUT_ABS;
+    _Timeout->user_data     = reinterpret_cast<::std::uintptr_t>(_Op) | _Timeout_tag;
+    return _Sqe;
+}
+
+// _Linked() records the completion of an operation with a linked timeout or
+// of the timeout itself. Once both arrived it returns true with the result
+// of the operation restored.
+
+inline auto stdnet::_Hidden::_Uring_context::_Linked(::stdnet::_Hidden::_Io_base* _Op, bool _Timeout) -> bool
+{
+    auto& _Link(*::std::launder(reinterpret_cast<_Linked_timeout*>(_Op->_Deadline->_Storage._Data)));
+    if (_Timeout)
+    {
+        _Link._Fired = this->_D_result == -ETIME;
+    }
+    else
+    {
+        _Link._Result = this->_D_result;
+        _Link._Flags  = this->_D_flags;
+    }
+    if (--_Link._Pending != 0u)
+    {
+        return false;
+    }
+    this->_D_result = _Link._Result;
+    this->_D_flags  = _Link._Flags;
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Read_wakeup() -> void
+{
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_READ, this->_D_wakeup._Native_handle(), nullptr));
+    _Sqe->addr      = reinterpret_cast<::std::uintptr_t>(&this->_D_wakeup_value);
+    _Sqe->len       = sizeof(this->_D_wakeup_value);
+    _Sqe->user_data = _Wakeup_tag;
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Wakeup() -> void
+{
+    this->_D_wakeup._Signal();
+}
+
+inline auto stdnet::_Hidden::_Uring_context::run_one() -> ::std::size_t
+{
+    return this->_Run_some(1u, ::std::chrono::steady_clock::time_point::max());
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Run_some(::std::size_t _Max,
+                                                    ::std::chrono::steady_clock::time_point _Deadline)
+    -> ::std::size_t
+{
+    this->_D_speculation._Reset();
+    this->_Update_now();
+    ::std::size_t _Count(this->_Run_posted());
+    bool          _Waited{false};
+    while (true)
+    {
+        while (_Count < _Max)
+        {
+            unsigned _Head(*this->_D_cq_head);
+            if (_Head == ::std::atomic_ref<unsigned>(*this->_D_cq_tail).load(::std::memory_order_acquire))
+            {
+                break;
+            }
+
+            ::io_uring_cqe const& _Cqe(this->_D_cqes[_Head & this->_D_cq_mask]);
+            ::std::uint64_t _Data(_Cqe.user_data);
+            auto _Op(reinterpret_cast<::stdnet::_Hidden::_Io_base*>(_Data & ~_Timeout_tag));
+            this->_D_result = _Cqe.res;
+            this->_D_flags  = _Cqe.flags;
+            ::std::atomic_ref<unsigned>(*this->_D_cq_head).store(_Head + 1u, ::std::memory_order_release);
+
+            if (_Data == _Wakeup_tag)
+            {
+                this->_Read_wakeup();
+            }
+            else if (_Op)
+            {
+                if (!(this->_D_flags & IORING_CQE_F_MORE))
+                {
+                    --this->_D_outstanding;
+                }
+                if (_Op->_Deadline && !this->_Linked(_Op, _Data & _Timeout_tag))
+                {
+                    continue;
+                }
+                if (_Op->_Work(*this, _Op))
+                {
+                    ++_Count;
+                }
+            }
+        }
+
+        if (_Count != 0u)
+        {
+            return _Count;
+        }
+        if (this->_D_outstanding == 0u && this->_D_unsubmitted == 0u)
+        {
+            return ::std::size_t{};
+        }
+        if (_Waited && _Deadline <= this->_Now())
+        {
+            return ::std::size_t{};
+        }
+        if (this->_Wait(_Deadline) < 0 && errno != EAGAIN && errno != EBUSY && errno != ETIME)
+        {
+            return ::std::size_t{};
+        }
+        this->_Update_now();
+        _Waited = true;
+        _Count = this->_Run_posted();
+    }
+}
+
+// _Wait() submits the pending entries and waits for at least one completion
+// if there are outstanding operations, but not beyond the deadline.
+
+inline auto stdnet::_Hidden::_Uring_context::_Wait(::std::chrono::steady_clock::time_point _Deadline) -> int
+{
+    unsigned _Min_complete(this->_D_outstanding? 1u: 0u);
+    if (_Min_complete == 0u || _Deadline == ::std::chrono::steady_clock::time_point::max())
+    {
+        return this->_Enter(_Min_complete, IORING_ENTER_GETEVENTS);
+    }
+
+    auto _Timeout(::std::max(_Deadline - ::std::chrono::steady_clock::now(), ::std::chrono::steady_clock::duration{}));
+    ::__kernel_timespec _Ts{};
+    _Ts.tv_sec  = ::std::chrono::duration_cast<::std::chrono::seconds>(_Timeout).count();
+    _Ts.tv_nsec = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(_Timeout % ::std::chrono::seconds(1)).count();
+    ::io_uring_getevents_arg _Arg{};
+    _Arg.sigmask_sz = _NSIG / 8;
+    _Arg.ts         = reinterpret_cast<::std::uintptr_t>(&_Ts);
+    return this->_Enter(_Min_complete, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &_Arg);
+}
+
+// ----------------------------------------------------------------------------
+// The _Result() function is the _Work function for socket operations: it
+// translates the completion result into a completion of the operation. A
+// send or receive which still needs more bytes is started again using _Start
+// (which tries the remainder directly if the socket uses speculative I/O)
+// unless the socket was released while the completion was in flight: the
+// operation then completes with the bytes transferred so far.
+
+template <typename _Operation, auto _Start>
+inline auto stdnet::_Hidden::_Uring_context::_Result(::stdnet::_Hidden::_Context_base& _Ctxt,
+                                                    ::stdnet::_Hidden::_Io_base* _Op) -> bool
+{
+    auto& _Context(static_cast<_Uring_context&>(_Ctxt));
+    auto& _Completion(*static_cast<_Operation*>(_Op));
+    int   _Result(_Context._D_result);
+
+    if (_Result == -ECANCELED)
+    {
+        // A linked timeout also cancels the operation.
+        if (_Op->_Deadline && ::std::launder(reinterpret_cast<_Linked_timeout*>(_Op->_Deadline->_Storage._Data))->_Fired)
+        {
+            _Completion._Error(::std::make_error_code(::std::errc::timed_out));
+        }
+        else
+        {
+            _Completion._Cancel();
+        }
+    }
+    else if (_Result < 0)
+    {
+        switch (-_Result)
+        {
+        default:
+            _Completion._Error(::std::error_code(-_Result, ::std::system_category()));
+            break;
+        case EAGAIN:
+            // The kernel gives up if the socket became ready without the
+            // operation making progress (e.g., a send woken by a queued
+            // MSG_ZEROCOPY notification): sends and receives start again.
+            if constexpr (_Start != nullptr)
+            {
+                if (!_Context._D_sockets._Valid(_Op->_Id))
+                {
+                    _Completion._Cancel();
+                }
+                else if (!(_Context.*_Start)(&_Completion))
+                {
+                    _Completion._Complete();
+                }
+            }
+            else
+            {
+                _Completion._Error(::std::error_code(-_Result, ::std::system_category()));
+            }
+            break;
+        case ECONNRESET:
+        case EPIPE:
+            if constexpr (::std::is_same_v<_Operation, _Receive_operation>)
+            {
+                _Completion._Complete();
+            }
+            else
+            {
+                _Completion._Error(::std::error_code(-_Result, ::std::system_category()));
+            }
+            break;
+        }
+    }
+    else
+    {
+        if constexpr (::std::is_same_v<_Operation, _Accept_operation>)
+        {
+            ::std::get<2>(_Completion) = _Context._Make_socket(_Result, false);
+            if (::std::get<2>(_Completion) == ::stdnet::_Hidden::_Socket_id::_Invalid)
+            {
+                _Completion._Error(::std::error_code(errno, ::std::system_category()));
+                return true;
+            }
+        }
+        else if constexpr (::std::is_same_v<_Operation, _Receive_operation>)
+        {
+            if (::stdnet::_Hidden::_Transferred(_Completion, ::std::size_t(_Result)))
+            {
+                if (!_Context._D_sockets._Valid(_Op->_Id) || !(_Context.*_Start)(&_Completion))
+                {
+                    _Completion._Complete();
+                }
+                return true;
+            }
+        }
+        _Completion._Complete();
+    }
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Prepare_timer(::stdnet::_Hidden::_Io_base* _Op, _Timer_storage& _Storage)
+    -> ::__kernel_timespec&
+{
+    static_assert(sizeof(::__kernel_timespec) <= sizeof(_Timer_storage));
+    _Op->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+        {
+            switch (static_cast<_Uring_context&>(_Ctxt)._D_result)
+            {
+            case -ETIME:
+            case 0:
+                _Op->_Complete();
+                break;
+            case -ECANCELED:
+                _Op->_Cancel();
+                break;
+            default:
+                _Op->_Error(::std::error_code(-static_cast<_Uring_context&>(_Ctxt)._D_result, ::std::system_category()));
+                break;
+            }
+            return true;
+        };
+    return *::new(static_cast<void*>(_Storage._Data)) ::__kernel_timespec{};
+}
+
+// ----------------------------------------------------------------------------
+
+inline auto stdnet::_Hidden::_Uring_context::_Cancel(::stdnet::_Hidden::_Cancel_node* _Node) -> void
+{
+    ::stdnet::_Hidden::_Io_base* _Op(_Node->_Op);
+    // The operation itself completes with ECANCELED once the kernel let go
+    // of it (or normally if it raced with the cancellation).
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_ASYNC_CANCEL, -1, nullptr));
+    _Sqe->addr = reinterpret_cast<::std::uintptr_t>(_Op);
+    _Node->_Done(_Node);
+}
+
+// With speculative I/O the operations are first tried directly and only
+// turned into submission queue entries if they would block. The context
+// doesn't track operations already handed to the kernel, i.e., speculative
+// I/O assumes there is at most one receive and one send outstanding per
+// socket which is normally the case for stream sockets.
+
+inline auto stdnet::_Hidden::_Uring_context::_Accept(::stdnet::_Hidden::_Context_base::_Accept_operation* _Op) -> bool
+{
+    if (auto _Rc = this->_D_speculation._Attempt(this->_D_sockets[_Op->_Id]._Speculative, *this, _Op, ::stdnet::_Hidden::_Try_accept))
+    {
+        return *_Rc;
+    }
+    _Op->_Work = _Result<_Accept_operation>;
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_ACCEPT, this->_Native_handle(_Op->_Id), _Op));
+    _Sqe->addr  = reinterpret_cast<::std::uintptr_t>(::std::get<0>(*_Op)._Data());
+    _Sqe->addr2 = reinterpret_cast<::std::uintptr_t>(&::std::get<1>(*_Op));
+    _Sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    return true;
+}
+
+// If an accepted connection can't be turned into a socket, the multishot
+// accept ends with the error. While the kernel still accepts connections
+// it is cancelled first: connections accepted in the meantime are closed
+// and the error (kept in place of the address size) is reported with the
+// final completion.
+
+inline auto stdnet::_Hidden::_Uring_context::_Accept_failed(::stdnet::_Hidden::_Context_base::_Accept_operation* _Op, int _Errno) -> void
+{
+    if (!(this->_D_flags & IORING_CQE_F_MORE))
+    {
+        _Op->_Error(::std::error_code(_Errno, ::std::system_category()));
+        return;
+    }
+    ::std::get<1>(*_Op) = ::socklen_t(_Errno);
+    _Op->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+        {
+            auto& _Context(static_cast<_Uring_context&>(_Ctxt));
+            auto& _Completion(*static_cast<_Accept_operation*>(_Op));
+            if (0 <= _Context._D_result)
+            {
+                ::close(_Context._D_result);
+            }
+            if (!(_Context._D_flags & IORING_CQE_F_MORE))
+            {
+                _Completion._Error(::std::error_code(int(::std::get<1>(_Completion)), ::std::system_category()));
+            }
+            return true;
+        };
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_ASYNC_CANCEL, -1, nullptr));
+    _Sqe->addr = reinterpret_cast<::std::uintptr_t>(_Op);
+}
+
+// The multishot accept produces a completion per connection. The peer
+// address is obtained separately as the kernel would overwrite the address
+// of a connection before its completion is processed. If the kernel ends the
+// multishot accept (e.g., because the completion queue overflowed) it is
+// submitted again.
+
+inline auto stdnet::_Hidden::_Uring_context::_Accept_multishot(::stdnet::_Hidden::_Context_base::_Accept_operation* _Op) -> bool
+{
+    if (!this->_D_multishot_accept)
+    {
+        _Op->_Error(::std::make_error_code(::std::errc::operation_not_supported));
+        return true;
+    }
+    _Op->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+        {
+            auto& _Context(static_cast<_Uring_context&>(_Ctxt));
+            auto& _Completion(*static_cast<_Accept_operation*>(_Op));
+            int   _Result(_Context._D_result);
+            if (_Result == -ECANCELED)
+            {
+                _Completion._Cancel();
+                return true;
+            }
+            if (_Result < 0)
+            {
+                _Completion._Error(::std::error_code(-_Result, ::std::system_category()));
+                return true;
+            }
+            ::std::get<1>(_Completion) = sizeof(::std::get<0>(_Completion));
+            if (::getpeername(_Result, ::std::get<0>(_Completion)._Data(), &::std::get<1>(_Completion)) < 0)
+            {
+                ::std::get<0>(_Completion) = ::stdnet::_Hidden::_Endpoint();
+            }
+            ::std::get<2>(_Completion) = _Context._Make_socket(_Result, false);
+            if (::std::get<2>(_Completion) == ::stdnet::_Hidden::_Socket_id::_Invalid)
+            {
+                _Context._Accept_failed(&_Completion, errno);
+                return true;
+            }
+            if (!(_Context._D_flags & IORING_CQE_F_MORE))
+            {
+                _Context._Accept_multishot(&_Completion);
+            }
+            _Completion._Complete();
+            return true;
+        };
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_ACCEPT, this->_Native_handle(_Op->_Id), _Op));
+    _Sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+    _Sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Connect(::stdnet::_Hidden::_Context_base::_Connect_operation* _Op) -> bool
+{
+    _Op->_Work = _Result<_Connect_operation>;
+    ::io_uring_sqe* _Sqe(this->_Get_io_sqe(IORING_OP_CONNECT, _Op));
+    _Sqe->addr = reinterpret_cast<::std::uintptr_t>(::std::get<0>(*_Op)._Data());
+    _Sqe->off  = ::std::get<0>(*_Op)._Size();
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Receive(::stdnet::_Hidden::_Context_base::_Receive_operation* _Op) -> bool
+{
+    if (auto _Rc = this->_D_speculation._Attempt(this->_D_sockets[_Op->_Id]._Speculative, *this, _Op, ::stdnet::_Hidden::_Try_receive))
+    {
+        return *_Rc;
+    }
+    _Op->_Work = _Result<_Receive_operation, &_Uring_context::_Receive>;
+    ::io_uring_sqe* _Sqe(this->_Get_io_sqe(IORING_OP_RECVMSG, _Op));
+    _Sqe->addr      = reinterpret_cast<::std::uintptr_t>(&::std::get<0>(*_Op));
+    _Sqe->len       = 1u;
+    _Sqe->msg_flags = ::std::get<1>(*_Op);
+    return true;
+}
+
+// The buffers of the receive pool are handed to the kernel as provided
+// buffers (group 0) when the first multishot receive is started: the kernel
+// picks a buffer when data arrives. Buffers given back to the pool are
+// provided again. The entries are submitted ahead of any receive using them
+// and their completions (user_data 0) are ignored. _D_provided counts the
+// buffers the kernel owns or will own once pending entries are submitted.
+
+inline auto stdnet::_Hidden::_Uring_context::_Provide_buffers() -> void
+{
+    auto& _Pool(this->_D_receive_pool);
+    if (_Pool._Take() < 0) // the buffers are already provided
+    {
+        return;
+    }
+    while (0 <= _Pool._Take())
+    {
+    }
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_PROVIDE_BUFFERS, int(_Pool._Count()), nullptr));
+    _Sqe->addr      = reinterpret_cast<::std::uintptr_t>(_Pool._Data(0u));
+    _Sqe->len       = unsigned(_Pool._Size());
+    _Sqe->off       = 0u;
+    _Sqe->buf_group = 0u;
+    this->_D_provided = _Pool._Count();
+    _Pool._Set_recycle(this, +[](void* _Context, ::stdnet::_Hidden::_Receive_pool::_Index _Buffer)
+        {
+            static_cast<_Uring_context*>(_Context)->_Provide(_Buffer);
+        });
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Provide(::stdnet::_Hidden::_Receive_pool::_Index _Buffer) -> void
+{
+    auto& _Pool(this->_D_receive_pool);
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_PROVIDE_BUFFERS, 1, nullptr));
+    _Sqe->addr      = reinterpret_cast<::std::uintptr_t>(_Pool._Data(_Buffer));
+    _Sqe->len       = unsigned(_Pool._Size());
+    _Sqe->off       = _Buffer;
+    _Sqe->buf_group = 0u;
+    ++this->_D_provided;
+}
+
+// Each completion of a multishot receive carries the id of the buffer the
+// kernel picked. If the kernel ends the multishot receive while the stream
+// is still open (e.g., because the completion queue overflowed) it is
+// submitted again. The kernel also ends it with ENOBUFS when it ran out of
+// buffers before returned buffers were submitted: the receive only fails if
+// all buffers are actually held by the user.
+
+inline auto stdnet::_Hidden::_Uring_context::_Receive_multishot(::stdnet::_Hidden::_Context_base::_Receive_multishot_operation* _Op) -> bool
+{
+    if (!this->_D_multishot_receive)
+    {
+        _Op->_Error(::std::make_error_code(::std::errc::operation_not_supported));
+        return true;
+    }
+    this->_Provide_buffers();
+    _Op->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+        {
+            auto& _Context(static_cast<_Uring_context&>(_Ctxt));
+            auto& _Completion(*static_cast<_Receive_multishot_operation*>(_Op));
+            int   _Result(_Context._D_result);
+            if (0 < _Result && (_Context._D_flags & IORING_CQE_F_BUFFER))
+            {
+                --_Context._D_provided;
+                ::std::get<1>(_Completion) = _Context._D_flags >> IORING_CQE_BUFFER_SHIFT;
+                ::std::get<2>(_Completion) = ::std::size_t(_Result);
+                if (!(_Context._D_flags & IORING_CQE_F_MORE))
+                {
+                    _Context._Receive_multishot(&_Completion);
+                }
+                _Completion._Complete();
+                return true;
+            }
+            if (_Result == -ENOBUFS && _Context._D_provided != 0u)
+            {
+                _Context._Receive_multishot(&_Completion);
+                return true;
+            }
+            switch (-_Result)
+            {
+            default:
+                _Completion._Error(::std::error_code(-_Result, ::std::system_category()));
+                break;
+            case 0:
+            case ECANCELED:
+            case ECONNRESET:
+            case EPIPE:
+                _Completion._Cancel();
+                break;
+            }
+            return true;
+        };
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_RECV, this->_Native_handle(_Op->_Id), _Op));
+    _Sqe->ioprio    = IORING_RECV_MULTISHOT;
+    _Sqe->flags    |= IOSQE_BUFFER_SELECT;
+    _Sqe->buf_group = 0u;
+    _Sqe->msg_flags = ::std::get<0>(*_Op);
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Send(::stdnet::_Hidden::_Context_base::_Send_operation* _Op) -> bool
+{
+    // _Send_operation and _Receive_operation are the same type: the result is
+    // the number of bytes transferred in both cases.
+    if (auto _Rc = this->_D_speculation._Attempt(this->_D_sockets[_Op->_Id]._Speculative, *this, _Op, ::stdnet::_Hidden::_Try_send))
+    {
+        return *_Rc;
+    }
+    _Op->_Work = _Result<_Send_operation, &_Uring_context::_Send>;
+    ::io_uring_sqe* _Sqe(this->_Get_io_sqe(IORING_OP_SENDMSG, _Op));
+    _Sqe->addr      = reinterpret_cast<::std::uintptr_t>(&::std::get<0>(*_Op));
+    _Sqe->len       = 1u;
+    _Sqe->msg_flags = ::std::get<1>(*_Op) | MSG_NOSIGNAL;
+    return true;
+}
+
+// io_uring has no sendfile operation: the operation polls for writability
+// and calls sendfile() on the non-blocking socket once it is writable.
+
+inline auto stdnet::_Hidden::_Uring_context::_Sendfile(::stdnet::_Hidden::_Context_base::_Sendfile_operation* _Op) -> bool
+{
+    ::std::error_code _Error;
+    ::stdnet::_Hidden::_Set_nonblocking(this->_D_sockets[_Op->_Id], this->_D_sockets._Handle(_Op->_Id), _Error);
+    if (_Error)
+    {
+        _Op->_Error(_Error);
+        return true;
+    }
+    if (auto _Rc = this->_D_speculation._Attempt(this->_D_sockets[_Op->_Id]._Speculative, *this, _Op, ::stdnet::_Hidden::_Try_sendfile))
+    {
+        return *_Rc;
+    }
+    _Op->_Work = [](::stdnet::_Hidden::_Context_base& _Ctxt, ::stdnet::_Hidden::_Io_base* _Op)
+        {
+            auto& _Context(static_cast<_Uring_context&>(_Ctxt));
+            if (_Context._D_result < 0)
+            {
+                return _Result<_Sendfile_operation>(_Ctxt, _Op);
+            }
+            switch (::stdnet::_Hidden::_Try_sendfile(_Ctxt, _Op))
+            {
+            case ::stdnet::_Hidden::_Io_result::_Done:
+                _Op->_Complete();
+                break;
+            case ::stdnet::_Hidden::_Io_result::_Failed:
+                break;
+            case ::stdnet::_Hidden::_Io_result::_Would_block:
+                if (!_Context._Sendfile(static_cast<_Sendfile_operation*>(_Op)))
+                {
+                    _Op->_Complete();
+                }
+                break;
+            }
+            return true;
+        };
+    ::io_uring_sqe* _Sqe(this->_Get_io_sqe(IORING_OP_POLL_ADD, _Op));
+    _Sqe->poll32_events = POLLOUT;
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Resume_after(::stdnet::_Hidden::_Context_base::_Resume_after_operation* _Op) -> bool
+{
+    auto _Duration(::std::get<0>(*_Op));
+    auto& _Ts(this->_Prepare_timer(_Op, ::std::get<1>(*_Op)));
+    _Ts.tv_sec  = ::std::chrono::duration_cast<::std::chrono::seconds>(_Duration).count();
+    _Ts.tv_nsec = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(_Duration % ::std::chrono::seconds(1)).count();
+
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_TIMEOUT, -1, _Op));
+    _Sqe->addr = reinterpret_cast<::std::uintptr_t>(&_Ts);
+    _Sqe->len  = 1u;
+    return true;
+}
+
+inline auto stdnet::_Hidden::_Uring_context::_Resume_at(::stdnet::_Hidden::_Context_base::_Resume_at_operation* _Op) -> bool
+{
+    auto _Time(::std::get<0>(*_Op).time_since_epoch());
+    auto& _Ts(this->_Prepare_timer(_Op, ::std::get<1>(*_Op)));
+    _Ts.tv_sec  = ::std::chrono::duration_cast<::std::chrono::seconds>(_Time).count();
+    _Ts.tv_nsec = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(_Time % ::std::chrono::seconds(1)).count();
+
+    ::io_uring_sqe* _Sqe(this->_Get_sqe(IORING_OP_TIMEOUT, -1, _Op));
+    _Sqe->addr          = reinterpret_cast<::std::uintptr_t>(&_Ts);
+    _Sqe->len           = 1u;
+    _Sqe->timeout_flags = IORING_TIMEOUT_ABS; // CLOCK_MONOTONIC, i.e., steady_clock
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif
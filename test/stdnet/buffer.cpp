@@ -62,4 +62,51 @@ TEST_CASE("buffer traits", "[buffer.synop]")
     using is_mutable_buffer_sequence = ::stdnet::is_mutable_buffer_sequence<int>;
     using is_const_buffer_sequence = ::stdnet::is_const_buffer_sequence<int>;
     using is_dynamic_buffer = ::stdnet::is_dynamic_buffer<int>;
-}
\ No newline at end of file
+}
+TEST_CASE("buffer_sequence", "[buffer.sequence]")
+{
+    char       head[] = {'h', 'e', 'a', 'd'};
+    char const body[] = {'b', 'o', 'd', 'y', '!'};
+
+    ::stdnet::buffer_sequence mutable_buffers(::stdnet::buffer(head), ::stdnet::buffer(head, 2u));
+    REQUIRE(::std::same_as<::stdnet::buffer_sequence<::stdnet::mutable_buffer, 2u>, decltype(mutable_buffers)>);
+    ::stdnet::buffer_sequence buffers(::stdnet::buffer(head), ::stdnet::buffer(body, 0u), ::stdnet::buffer(body, 5u));
+    REQUIRE(::std::same_as<::stdnet::buffer_sequence<::stdnet::const_buffer, 3u>, decltype(buffers)>);
+
+    REQUIRE(buffers.size() == 3u);
+    REQUIRE(buffers.data()[0].iov_base == head);
+    REQUIRE(buffers.data()[2].iov_len == 5u);
+
+    buffers.consume(2u);
+    REQUIRE(buffers.size() == 3u);
+    REQUIRE(buffers.data()[0].iov_base == head + 2);
+    REQUIRE(buffers.data()[0].iov_len == 2u);
+
+    buffers.consume(3u);
+    REQUIRE(buffers.size() == 1u);
+    REQUIRE(buffers.data()[0].iov_base == body + 1);
+    REQUIRE(buffers.data()[0].iov_len == 4u);
+    REQUIRE(!buffers.empty());
+
+    buffers.consume(4u);
+    REQUIRE(buffers.size() == 0u);
+    REQUIRE(buffers.empty());
+}
+
+TEST_CASE("buffer sequence traits", "[buffer.sequence]")
+{
+    using mutable_sequence = ::stdnet::buffer_sequence<::stdnet::mutable_buffer, 2u>;
+    using const_sequence = ::stdnet::buffer_sequence<::stdnet::const_buffer, 2u>;
+
+    REQUIRE(::stdnet::is_mutable_buffer_sequence<::stdnet::mutable_buffer>::value);
+    REQUIRE(::stdnet::is_mutable_buffer_sequence<mutable_sequence>::value);
+    REQUIRE(!::stdnet::is_mutable_buffer_sequence<::stdnet::const_buffer>::value);
+    REQUIRE(!::stdnet::is_mutable_buffer_sequence<const_sequence>::value);
+    REQUIRE(!::stdnet::is_mutable_buffer_sequence<int>::value);
+
+    REQUIRE(::stdnet::is_const_buffer_sequence<::stdnet::mutable_buffer>::value);
+    REQUIRE(::stdnet::is_const_buffer_sequence<mutable_sequence>::value);
+    REQUIRE(::stdnet::is_const_buffer_sequence<::stdnet::const_buffer>::value);
+    REQUIRE(::stdnet::is_const_buffer_sequence<const_sequence>::value);
+    REQUIRE(!::stdnet::is_const_buffer_sequence<int>::value);
+}
@@ -0,0 +1,117 @@
+// test/stdnet/buffer_pool.cpp                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+#include <stdnet/buffer_pool.hpp>
+#include <stdnet/buffer.hpp>
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <set>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+TEST_CASE("pooled buffers are returned to the pool", "[buffer_pool]")
+{
+    REQUIRE(!::std::is_copy_constructible_v<::stdnet::pooled_buffer>);
+    REQUIRE(::std::is_move_constructible_v<::stdnet::pooled_buffer>);
+
+    ::stdnet::buffer_pool pool(1000u);
+    REQUIRE(pool.buffer_size() == 1024u);
+
+    auto first(pool.lease());
+    REQUIRE(first);
+    REQUIRE(first.size() == 1024u);
+    char* data(first.data());
+    data[0] = 'x';
+    data[first.size() - 1u] = 'y';
+
+    ::stdnet::pooled_buffer moved(::std::move(first));
+    REQUIRE(!first);
+    REQUIRE(first.size() == 0u);
+    REQUIRE(moved.data() == data);
+
+    auto buffer(::stdnet::buffer(moved));
+    REQUIRE(buffer.data()->iov_base == data);
+    REQUIRE(buffer.data()->iov_len == 1024u);
+
+    moved.reset();
+    REQUIRE(!moved);
+    REQUIRE(pool.lease().data() == data);
+}
+
+TEST_CASE("buffer pool leases distinct buffers", "[buffer_pool]")
+{
+    ::stdnet::buffer_pool                  pool(4096u, 2u);
+    ::std::vector<::stdnet::pooled_buffer> buffers;
+    ::std::set<char*>                      addresses;
+    for (int i{}; i != 2000; ++i)
+    {
+        buffers.push_back(pool.lease());
+        addresses.insert(buffers.back().data());
+    }
+    REQUIRE(addresses.size() == 2000u);
+
+    // Releasing the buffers on other threads than the leasing one, some
+    // without a cache of their own.
+    ::std::vector<::std::thread> threads;
+    for (int t{}; t != 4; ++t)
+    {
+        threads.emplace_back([&pool, &buffers, t]{
+            for (::std::size_t i(t); i < buffers.size(); i += 4u)
+            {
+                buffers[i].reset();
+            }
+            for (int i{}; i != 1000; ++i)
+            {
+                auto buffer(pool.lease());
+                buffer.data()[0] = char(i);
+            }
+        });
+    }
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+    addresses.clear();
+    for (auto& buffer: buffers)
+    {
+        buffer = pool.lease();
+        addresses.insert(buffer.data());
+    }
+    REQUIRE(addresses.size() == 2000u);
+}
+
+TEST_CASE("buffer pool reclaims the caches of exited threads", "[buffer_pool]")
+{
+    // More threads than caches run one after another: each gets a cache
+    // and, as the buffers cached by its predecessor were flushed to the
+    // shared list, leases the same buffer.
+    ::stdnet::buffer_pool pool(4096u);
+    ::std::vector<char*>  addresses;
+    for (int t{}; t != 100; ++t)
+    {
+        ::std::thread([&pool, &addresses]{
+            addresses.push_back(pool.lease().data());
+        }).join();
+    }
+    REQUIRE(::std::set<char*>(addresses.begin(), addresses.end()).size() == 1u);
+}
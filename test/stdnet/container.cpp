@@ -0,0 +1,97 @@
+// test/stdnet/container.cpp                                          -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+#include <stdnet/container.hpp>
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+    struct record
+    {
+        int* live;
+        int  value;
+        record(int* live, int value): live(live), value(value) { ++*this->live; }
+        record(record const&) = delete;
+        ~record() { --*this->live; }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+TEST_CASE("container detects stale ids", "[container]")
+{
+    int live{};
+    {
+        ::stdnet::_Hidden::_Container<record> container;
+        auto id0(container._Insert(10, &live, 0));
+        auto id1(container._Insert(11, &live, 1));
+        REQUIRE(live == 2);
+        REQUIRE(container._Size() == 2u);
+        REQUIRE(container._Valid(id0));
+        REQUIRE(container._Handle(id1) == 11);
+        REQUIRE(container[id1].value == 1);
+
+        container._Erase(id0);
+        REQUIRE(live == 1);
+        REQUIRE(!container._Valid(id0));
+
+        auto id2(container._Insert(12, &live, 2));
+        REQUIRE(id2 != id0);
+        REQUIRE(id2 != ::stdnet::_Hidden::_Socket_id::_Invalid);
+        REQUIRE(!container._Valid(id0));
+        REQUIRE(container._Valid(id2));
+        REQUIRE(container._Handle(id2) == 12);
+        REQUIRE(container[id2].value == 2);
+        REQUIRE(!container._Valid(::stdnet::_Hidden::_Socket_id::_Invalid));
+    }
+    REQUIRE(live == 0);
+}
+
+TEST_CASE("container doesn't move records when growing", "[container]")
+{
+    int                                          live{};
+    ::stdnet::_Hidden::_Container<record>        container;
+    ::std::vector<::stdnet::_Hidden::_Socket_id> ids;
+    ::std::vector<record*>                       addresses;
+    for (int i{}; i != 10'000; ++i)
+    {
+        ids.push_back(container._Insert(i, &live, i));
+        addresses.push_back(&container[ids.back()]);
+    }
+    for (::std::size_t i{}; i != ids.size(); i += 2u)
+    {
+        container._Erase(ids[i]);
+    }
+    for (int i{}; i != 20'000; ++i)
+    {
+        container._Insert(i, &live, i);
+    }
+    bool stable{true};
+    for (::std::size_t i{1u}; i < ids.size(); i += 2u)
+    {
+        stable = stable && container._Valid(ids[i]) && &container[ids[i]] == addresses[i]
+            && container[ids[i]].value == int(i);
+    }
+    REQUIRE(stable);
+    REQUIRE(live == 25'000);
+}
@@ -0,0 +1,449 @@
+// test/stdnet/context.cpp                                            -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+#include <stdnet/epoll_context.hpp>
+#include <stdnet/libevent_context.hpp>
+#include <stdnet/poll_context.hpp>
+#include <stdnet/uring_context.hpp>
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+// The test cases run against each backend.
+
+#define CONTEXTS                               \
+    ::stdnet::_Hidden::_Epoll_context,         \
+    ::stdnet::_Hidden::_Libevent_context,      \
+    ::stdnet::_Hidden::_Poll_context,          \
+    ::stdnet::_Hidden::_Uring_context
+
+namespace
+{
+    template <typename Operation>
+    struct test_operation
+        : Operation
+    {
+        int* count;
+        bool completed{};
+        bool cancelled{};
+        test_operation(int* count, ::stdnet::_Hidden::_Socket_id id = {}, int event = 0)
+            : Operation(id, event)
+            , count(count)
+        {
+        }
+        auto _Complete() -> void override { ++*this->count; this->completed = true; }
+        auto _Error(::std::error_code) -> void override { ++*this->count; }
+        auto _Cancel() -> void override { ++*this->count; this->cancelled = true; }
+    };
+
+    struct cancel_request
+        : ::stdnet::_Hidden::_Cancel_node
+    {
+        bool done{};
+        cancel_request(::stdnet::_Hidden::_Io_base* op)
+            : ::stdnet::_Hidden::_Cancel_node(op, +[](::stdnet::_Hidden::_Cancel_node* node){
+                static_cast<cancel_request*>(node)->done = true;
+            })
+        {
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+TEMPLATE_TEST_CASE("echo through a socket pair", "[context]", CONTEXTS)
+{
+    using context = ::stdnet::_Hidden::_Context_base;
+
+    TestType backend;
+    context& ctxt(backend);
+
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    auto client(ctxt._Make_socket(fds[0], true));
+    auto server(ctxt._Make_socket(fds[1], true));
+
+    for (int i{}; i != 10; ++i)
+    {
+        char    send_buffer[] = "hello";
+        char    receive_buffer[sizeof(send_buffer)]{};
+        ::iovec send_vec{send_buffer, sizeof(send_buffer)};
+        ::iovec receive_vec{receive_buffer, sizeof(receive_buffer)};
+
+        int count{};
+        test_operation<context::_Receive_operation> receive(&count, server, POLLIN);
+        ::std::get<0>(receive).msg_iov    = &receive_vec;
+        ::std::get<0>(receive).msg_iovlen = 1;
+        test_operation<context::_Send_operation> send(&count, client, POLLOUT);
+        ::std::get<0>(send).msg_iov    = &send_vec;
+        ::std::get<0>(send).msg_iovlen = 1;
+        test_operation<context::_Resume_after_operation> timer(&count);
+        ::std::get<0>(timer) = ::std::chrono::microseconds(1);
+
+        if (!ctxt._Receive(&receive)) receive._Complete();
+        if (!ctxt._Send(&send)) send._Complete();
+        if (!ctxt._Resume_after(&timer)) timer._Complete();
+        while (count < 3 && ctxt.run_one())
+        {
+        }
+        REQUIRE(receive.completed);
+        REQUIRE(send.completed);
+        REQUIRE(timer.completed);
+        REQUIRE(::std::string(receive_buffer) == "hello");
+    }
+
+    ::std::error_code error;
+    ctxt._Release(client, error);
+    ctxt._Release(server, error);
+    REQUIRE(!error);
+}
+
+TEMPLATE_TEST_CASE("cancellation ends waiting operations", "[context]", CONTEXTS)
+{
+    using context = ::stdnet::_Hidden::_Context_base;
+
+    TestType backend;
+    context& ctxt(backend);
+
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    auto server(ctxt._Make_socket(fds[1], true));
+
+    char    buffer[8];
+    ::iovec vec{buffer, sizeof(buffer)};
+    int     count{};
+    test_operation<context::_Receive_operation> receive(&count, server, POLLIN);
+    ::std::get<0>(receive).msg_iov    = &vec;
+    ::std::get<0>(receive).msg_iovlen = 1;
+    test_operation<context::_Resume_after_operation> timer(&count);
+    ::std::get<0>(timer) = ::std::chrono::hours(1);
+
+    REQUIRE(ctxt._Receive(&receive));
+    REQUIRE(ctxt._Resume_after(&timer));
+    cancel_request cancel_receive(&receive);
+    cancel_request cancel_timer(&timer);
+    ctxt._Cancel(&cancel_receive);
+    ctxt._Cancel(&cancel_timer);
+    REQUIRE(cancel_receive.done);
+    REQUIRE(cancel_timer.done);
+    while (count < 2 && ctxt.run_one())
+    {
+    }
+    REQUIRE(receive.cancelled);
+    REQUIRE(timer.cancelled);
+
+    ::std::error_code error;
+    ctxt._Release(server, error);
+    REQUIRE(!error);
+    ::close(fds[0]);
+}
+
+TEMPLATE_TEST_CASE("releasing a socket cancels its operations", "[context]", CONTEXTS)
+{
+    using context = ::stdnet::_Hidden::_Context_base;
+
+    TestType backend;
+    context& ctxt(backend);
+
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    auto server(ctxt._Make_socket(fds[1], true));
+
+    char    buffer[8];
+    ::iovec vec{buffer, sizeof(buffer)};
+    int     count{};
+    test_operation<context::_Receive_operation> receive(&count, server, POLLIN);
+    ::std::get<0>(receive).msg_iov    = &vec;
+    ::std::get<0>(receive).msg_iovlen = 1;
+    REQUIRE(ctxt._Receive(&receive));
+
+    ::std::error_code error;
+    ctxt._Release(server, error);
+    REQUIRE(!error);
+    while (count < 1 && ctxt.run_one())
+    {
+    }
+    REQUIRE(receive.cancelled);
+
+    cancel_request late(&receive);
+    ctxt._Cancel(&late);
+    REQUIRE(late.done);
+    REQUIRE(count == 1);
+    ::close(fds[0]);
+}
+
+TEMPLATE_TEST_CASE("multishot accept stays armed until released", "[context]", CONTEXTS)
+{
+    using context = ::stdnet::_Hidden::_Context_base;
+
+    struct multishot
+        : context::_Accept_operation
+    {
+        context* ctxt;
+        int      accepted{};
+        int      cancelled{};
+        multishot(context* ctxt, ::stdnet::_Hidden::_Socket_id id)
+            : context::_Accept_operation(id, POLLIN)
+            , ctxt(ctxt)
+        {
+        }
+        auto _Complete() -> void override
+        {
+            ++this->accepted;
+            ::std::error_code error;
+            this->ctxt->_Release(*::std::get<2>(*this), error);
+        }
+        auto _Error(::std::error_code) -> void override {}
+        auto _Cancel() -> void override { ++this->cancelled; }
+    };
+
+    TestType backend;
+    context& ctxt(backend);
+
+    // An abstract unix domain socket avoids a file system entry.
+    ::sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    ::std::strcpy(address.sun_path + 1, "stdnet-multishot-accept");
+    ::socklen_t size(offsetof(::sockaddr_un, sun_path) + 1 + ::std::strlen(address.sun_path + 1));
+
+    ::std::error_code error;
+    auto listener(ctxt._Make_socket(AF_UNIX, SOCK_STREAM, 0, error));
+    ctxt._Bind(listener, ::stdnet::_Hidden::_Endpoint(&address, size), error);
+    ctxt._Listen(listener, 16, error);
+    REQUIRE(!error);
+
+    multishot accept(&ctxt, listener);
+    REQUIRE(ctxt._Accept_multishot(&accept));
+
+    int clients[5];
+    for (int& client: clients)
+    {
+        client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(::connect(client, reinterpret_cast<::sockaddr*>(&address), size) == 0);
+    }
+    while (accept.accepted < 3 && ctxt.run_one())
+    {
+    }
+    REQUIRE(accept.accepted == 3);
+    while (accept.accepted < 5 && ctxt.run_one())
+    {
+    }
+    REQUIRE(accept.accepted == 5);
+    REQUIRE(accept.cancelled == 0);
+
+    // Some backends complete the cancelled operation asynchronously.
+    ctxt._Release(listener, error);
+    REQUIRE(!error);
+    while (accept.cancelled == 0 && ctxt.run_one())
+    {
+    }
+    REQUIRE(accept.cancelled == 1);
+    for (int client: clients)
+    {
+        ::close(client);
+    }
+}
+
+TEMPLATE_TEST_CASE("multishot receive runs out of held buffers", "[context]", CONTEXTS)
+{
+    using context = ::stdnet::_Hidden::_Context_base;
+
+    struct multishot
+        : context::_Receive_multishot_operation
+    {
+        context*                                ctxt;
+        ::std::vector<::stdnet::receive_buffer> held;
+        ::std::string                           data;
+        ::std::error_code                       error;
+        int                                     cancelled{};
+        multishot(context* ctxt, ::stdnet::_Hidden::_Socket_id id)
+            : context::_Receive_multishot_operation(id, POLLIN)
+            , ctxt(ctxt)
+        {
+        }
+        auto _Complete() -> void override
+        {
+            ::stdnet::receive_buffer buffer(&this->ctxt->_D_receive_pool, ::std::get<1>(*this), ::std::get<2>(*this));
+            this->data.append(buffer.data(), buffer.size());
+            this->held.push_back(::std::move(buffer));
+        }
+        auto _Error(::std::error_code error) -> void override { this->error = error; }
+        auto _Cancel() -> void override { ++this->cancelled; }
+    };
+
+    TestType backend;
+    context& ctxt(backend);
+    ctxt._D_receive_pool._Configure(4u, 8u);
+
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    multishot receive(&ctxt, ctxt._Make_socket(fds[0], true));
+    ::std::get<0>(receive) = 0;
+    REQUIRE(ctxt._Receive_multishot(&receive));
+
+    ::std::string message("abcdefghijklmnopqrstuvwxyz0123456789ABCD");
+    REQUIRE(::write(fds[1], message.data(), message.size()) == ::ssize_t(message.size()));
+    while (!receive.error && ctxt.run_one())
+    {
+    }
+    REQUIRE(receive.held.size() == 4u);
+    REQUIRE(receive.data == message.substr(0u, 32u));
+    REQUIRE(receive.error == ::std::error_code(ENOBUFS, ::std::system_category()));
+    REQUIRE(receive.cancelled == 0);
+
+    receive.held.clear();
+    ::std::error_code error;
+    ctxt._Release(receive._Id, error);
+    ::close(fds[1]);
+}
+
+TEMPLATE_TEST_CASE("transfers all needed bytes with one operation", "[context]", CONTEXTS)
+{
+    using context = ::stdnet::_Hidden::_Context_base;
+
+    TestType backend;
+    context& ctxt(backend);
+
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    int small{4096};
+    ::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    auto client(ctxt._Make_socket(fds[0], false));
+    auto server(ctxt._Make_socket(fds[1], false));
+
+    ::std::vector<char> head(100u), body(1u << 20), received(head.size() + body.size());
+    for (::std::size_t i{}; i != body.size(); ++i)
+    {
+        body[i] = char(i * 7u);
+    }
+    ::iovec send_vecs[]{{head.data(), head.size()}, {body.data(), body.size()}};
+    ::iovec receive_vec{received.data(), received.size()};
+
+    int count{};
+    test_operation<context::_Send_operation> send(&count, client, POLLOUT);
+    ::std::get<0>(send).msg_iov    = send_vecs;
+    ::std::get<0>(send).msg_iovlen = 2;
+    ::std::get<3>(send)            = received.size();
+    test_operation<context::_Receive_operation> receive(&count, server, POLLIN);
+    ::std::get<0>(receive).msg_iov    = &receive_vec;
+    ::std::get<0>(receive).msg_iovlen = 1;
+    ::std::get<3>(receive)            = received.size();
+
+    if (!ctxt._Send(&send)) send._Complete();
+    if (!ctxt._Receive(&receive)) receive._Complete();
+    while (count < 2 && ctxt.run_one())
+    {
+    }
+    REQUIRE(send.completed);
+    REQUIRE(receive.completed);
+    REQUIRE(::std::get<2>(send) == received.size());
+    REQUIRE(::std::get<2>(receive) == received.size());
+    REQUIRE(::std::equal(body.begin(), body.end(), received.begin() + head.size()));
+
+    // A receive needing more bytes than the peer sends ends with the stream.
+    test_operation<context::_Receive_operation> rest(&count, server, POLLIN);
+    receive_vec = ::iovec{received.data(), received.size()};
+    ::std::get<0>(rest).msg_iov    = &receive_vec;
+    ::std::get<0>(rest).msg_iovlen = 1;
+    ::std::get<3>(rest)            = 100u;
+    if (!ctxt._Receive(&rest)) rest._Complete();
+    REQUIRE(::write(fds[0], "partial", 7) == 7);
+    ::shutdown(fds[0], SHUT_WR);
+    while (count < 3 && ctxt.run_one())
+    {
+    }
+    REQUIRE(rest.completed);
+    REQUIRE(::std::get<2>(rest) == 7u);
+
+    ::std::error_code error;
+    ctxt._Release(client, error);
+    ctxt._Release(server, error);
+}
+
+TEMPLATE_TEST_CASE("sends a file range with one operation", "[context]", CONTEXTS)
+{
+    using context = ::stdnet::_Hidden::_Context_base;
+
+    TestType backend;
+    context& ctxt(backend);
+
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    int small{4096};
+    ::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    auto client(ctxt._Make_socket(fds[0], false));
+    auto server(ctxt._Make_socket(fds[1], false));
+
+    ::std::FILE* file(::std::tmpfile());
+    REQUIRE(file);
+    ::std::vector<char> content(1u << 18), received(content.size());
+    for (::std::size_t i{}; i != content.size(); ++i)
+    {
+        content[i] = char(i * 7u);
+    }
+    REQUIRE(::write(::fileno(file), content.data(), content.size()) == ::ssize_t(content.size()));
+    ::iovec receive_vec{received.data(), received.size()};
+
+    // The range starts past the beginning and extends beyond the end of the
+    // file: the operation completes with the bytes up to the end of the file.
+    ::std::size_t const offset{100u};
+    int count{};
+    test_operation<context::_Sendfile_operation> send(&count, client, POLLOUT);
+    ::std::get<0>(send) = ::fileno(file);
+    ::std::get<1>(send) = ::off_t(offset);
+    ::std::get<2>(send) = content.size();
+    test_operation<context::_Receive_operation> receive(&count, server, POLLIN);
+    ::std::get<0>(receive).msg_iov    = &receive_vec;
+    ::std::get<0>(receive).msg_iovlen = 1;
+    ::std::get<3>(receive)            = content.size() - offset;
+
+    if (!ctxt._Sendfile(&send)) send._Complete();
+    if (!ctxt._Receive(&receive)) receive._Complete();
+    while (count < 2 && ctxt.run_one())
+    {
+    }
+    REQUIRE(send.completed);
+    REQUIRE(receive.completed);
+    REQUIRE(::std::get<3>(send) == content.size() - offset);
+    REQUIRE(::std::get<2>(receive) == content.size() - offset);
+    REQUIRE(::std::equal(content.begin() + offset, content.end(), received.begin()));
+
+    ::std::fclose(file);
+    ::std::error_code error;
+    ctxt._Release(client, error);
+    ctxt._Release(server, error);
+}
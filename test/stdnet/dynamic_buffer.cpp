@@ -0,0 +1,114 @@
+// test/stdnet/dynamic_buffer.cpp                                     -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+#include <stdnet/dynamic_buffer.hpp>
+#include <stdnet/buffer.hpp>
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// ----------------------------------------------------------------------------
+
+TEST_CASE("dynamic buffer keeps unconsumed bytes contiguous", "[dynamic_buffer]")
+{
+    REQUIRE(::stdnet::is_dynamic_buffer<::stdnet::dynamic_buffer>::value);
+    REQUIRE(!::stdnet::is_dynamic_buffer<::stdnet::mutable_buffer>::value);
+
+    ::stdnet::dynamic_buffer buffer(64u);
+    REQUIRE(buffer.size() == 0u);
+    REQUIRE(buffer.max_size() == 64u);
+
+    auto space(buffer.prepare(16u));
+    REQUIRE(space.data()->iov_len == 16u);
+    ::std::memcpy(space.data()->iov_base, "hello, world", 12u);
+    buffer.commit(12u);
+    REQUIRE(buffer.view() == "hello, world");
+    REQUIRE(buffer.data().data()->iov_len == 12u);
+
+    buffer.consume(7u);
+    REQUIRE(buffer.view() == "world");
+    char const* before(buffer.view().data());
+    ::std::size_t capacity(buffer.capacity());
+
+    // Space available after the bytes is provided in place.
+    REQUIRE(buffer.tail_capacity() == capacity - 12u);
+    space = buffer.prepare(buffer.tail_capacity());
+    REQUIRE(buffer.view().data() == before);
+    REQUIRE(space.data()->iov_base == before + 5);
+
+    // The consumed prefix is larger than the remaining bytes: these are moved
+    // to the front instead of growing the buffer.
+    space = buffer.prepare(capacity - 5u);
+    REQUIRE(buffer.capacity() == capacity);
+    REQUIRE(buffer.view() == "world");
+    REQUIRE(buffer.view().data() < before);
+    ::std::memcpy(space.data()->iov_base, "!", 1u);
+    buffer.commit(1u);
+    REQUIRE(buffer.view() == "world!");
+
+    space = buffer.prepare(40u);
+    REQUIRE(capacity < buffer.capacity());
+    REQUIRE(buffer.view() == "world!");
+
+    REQUIRE_THROWS_AS(buffer.prepare(59u), ::std::length_error);
+
+    buffer.consume(100u);
+    REQUIRE(buffer.size() == 0u);
+}
+
+TEST_CASE("delimiter search agrees with string_view::find", "[dynamic_buffer]")
+{
+    ::std::mt19937 gen(17);
+    ::std::uniform_int_distribution<int> byte('a', 'c');
+    for (int round{}; round != 200; ++round)
+    {
+        ::std::string text(gen() % 300u, ' ');
+        for (char& c: text)
+        {
+            c = char(byte(gen));
+        }
+        ::std::string needle(1u + gen() % 6u, ' ');
+        for (char& c: needle)
+        {
+            c = char(byte(gen));
+        }
+        for (::std::size_t offset{}; offset <= text.size(); offset += 1u + offset / 4u)
+        {
+            ::std::string_view view(text);
+            char const* end(view.data() + view.size());
+            char const* pos(::stdnet::_Hidden::_Search(view.data() + offset, end, needle));
+            ::std::size_t expect(view.find(needle, offset));
+            REQUIRE((pos == end? ::std::string_view::npos: ::std::size_t(pos - view.data())) == expect);
+        }
+    }
+
+    ::std::string text(100u, 'x');
+    text.replace(60u, 4u, "\r\n\r\n");
+    for (::std::size_t begin{}; begin != 61u; ++begin)
+    {
+        REQUIRE(::stdnet::_Hidden::_Search(text.data() + begin, text.data() + 64u, "\r\n\r\n")
+                == text.data() + 60u);
+        REQUIRE(::stdnet::_Hidden::_Search(text.data() + begin, text.data() + 63u, "\r\n\r\n")
+                == text.data() + 63u);
+    }
+}
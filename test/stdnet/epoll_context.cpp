@@ -0,0 +1,101 @@
+// test/stdnet/epoll_context.cpp                                      -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+#include <stdnet/epoll_context.hpp>
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <ctime>
+#include <system_error>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+    template <typename Operation>
+    struct test_operation
+        : Operation
+    {
+        int* count;
+        bool completed{};
+        test_operation(int* count, ::stdnet::_Hidden::_Socket_id id = {}, int event = 0)
+            : Operation(id, event)
+            , count(count)
+        {
+        }
+        auto _Complete() -> void override { ++*this->count; this->completed = true; }
+        auto _Error(::std::error_code) -> void override { ++*this->count; }
+        auto _Cancel() -> void override { ++*this->count; }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+TEST_CASE("epoll doesn't wake up for idle sockets whose peer closed", "[epoll_context]")
+{
+    using context = ::stdnet::_Hidden::_Context_base;
+
+    ::stdnet::_Hidden::_Epoll_context epoll;
+    context& ctxt(epoll);
+
+    // The kernel reports EPOLLHUP even without any registered interest: a
+    // socket which was never used and one which completed a receive are
+    // left idle while their peers close.
+    int unused[2], used[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, unused) == 0);
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, used) == 0);
+    auto first(ctxt._Make_socket(unused[0], true));
+    auto second(ctxt._Make_socket(used[0], true));
+
+    int     count{};
+    char    buffer[4];
+    ::iovec vec{buffer, sizeof(buffer)};
+    test_operation<context::_Receive_operation> receive(&count, second, POLLIN);
+    ::std::get<0>(receive).msg_iov    = &vec;
+    ::std::get<0>(receive).msg_iovlen = 1;
+    if (!ctxt._Receive(&receive)) receive._Complete();
+    REQUIRE(::write(used[1], "x", 1) == 1);
+    while (count < 1 && ctxt.run_one())
+    {
+    }
+    REQUIRE(receive.completed);
+    ::close(unused[1]);
+    ::close(used[1]);
+
+    // Waiting for the timer blocks instead of spinning: it uses a small
+    // fraction of the waiting time in CPU time.
+    test_operation<context::_Resume_after_operation> timer(&count);
+    ::std::get<0>(timer) = ::std::chrono::milliseconds(200);
+    ::std::clock_t before(::std::clock());
+    if (!ctxt._Resume_after(&timer)) timer._Complete();
+    while (count < 2 && ctxt.run_one())
+    {
+    }
+    ::std::clock_t after(::std::clock());
+    REQUIRE(timer.completed);
+    REQUIRE(after - before < CLOCKS_PER_SEC / 20);
+
+    ::std::error_code error;
+    ctxt._Release(first, error);
+    ctxt._Release(second, error);
+    REQUIRE(!error);
+}
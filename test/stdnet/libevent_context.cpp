@@ -0,0 +1,187 @@
+// test/stdnet/libevent_context.cpp                                   -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+#include <stdnet/libevent_context.hpp>
+#include <catch2/catch_all.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <system_error>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+    ::std::atomic<::std::size_t> allocations{};
+
+    auto counting_malloc(::std::size_t size) -> void*
+    {
+        ++allocations;
+        return ::std::malloc(size);
+    }
+    auto counting_realloc(void* ptr, ::std::size_t size) -> void*
+    {
+        ++allocations;
+        return ::std::realloc(ptr, size);
+    }
+
+    // libevent requires the memory functions to be set before anything else
+    // is done with libevent.
+    bool const memory_functions_set{
+        (::event_set_mem_functions(counting_malloc, counting_realloc, ::std::free), true)
+    };
+
+    template <typename Operation>
+    struct test_operation
+        : Operation
+    {
+        int* count;
+        bool completed{};
+        test_operation(int* count, ::stdnet::_Hidden::_Socket_id id = {}, int event = 0)
+            : Operation(id, event)
+            , count(count)
+        {
+        }
+        auto _Complete() -> void override { ++*this->count; this->completed = true; }
+        auto _Error(::std::error_code) -> void override { ++*this->count; }
+        auto _Cancel() -> void override { ++*this->count; }
+    };
+}
+
+// All forms of the global allocation functions are replaced such that any
+// allocation is counted and every deallocation matches its allocation.
+
+namespace
+{
+    auto counting_allocate(::std::size_t size, ::std::size_t alignment = alignof(::std::max_align_t)) noexcept -> void*
+    {
+        ++allocations;
+        size = size? size: 1u;
+        return alignment <= alignof(::std::max_align_t)
+            ? ::std::malloc(size)
+            : ::std::aligned_alloc(alignment, (size + alignment - 1u) / alignment * alignment);
+    }
+    auto checked(void* ptr) -> void*
+    {
+        if (ptr == nullptr)
+        {
+            throw ::std::bad_alloc();
+        }
+        return ptr;
+    }
+}
+
+auto operator new(::std::size_t size) -> void* { return checked(counting_allocate(size)); }
+auto operator new[](::std::size_t size) -> void* { return checked(counting_allocate(size)); }
+auto operator new(::std::size_t size, ::std::nothrow_t const&) noexcept -> void* { return counting_allocate(size); }
+auto operator new[](::std::size_t size, ::std::nothrow_t const&) noexcept -> void* { return counting_allocate(size); }
+auto operator new(::std::size_t size, ::std::align_val_t alignment) -> void*
+{
+    return checked(counting_allocate(size, ::std::size_t(alignment)));
+}
+auto operator new[](::std::size_t size, ::std::align_val_t alignment) -> void*
+{
+    return checked(counting_allocate(size, ::std::size_t(alignment)));
+}
+auto operator new(::std::size_t size, ::std::align_val_t alignment, ::std::nothrow_t const&) noexcept -> void*
+{
+    return counting_allocate(size, ::std::size_t(alignment));
+}
+auto operator new[](::std::size_t size, ::std::align_val_t alignment, ::std::nothrow_t const&) noexcept -> void*
+{
+    return counting_allocate(size, ::std::size_t(alignment));
+}
+
+auto operator delete(void* ptr) noexcept -> void { ::std::free(ptr); }
+auto operator delete[](void* ptr) noexcept -> void { ::std::free(ptr); }
+auto operator delete(void* ptr, ::std::size_t) noexcept -> void { ::std::free(ptr); }
+auto operator delete[](void* ptr, ::std::size_t) noexcept -> void { ::std::free(ptr); }
+auto operator delete(void* ptr, ::std::nothrow_t const&) noexcept -> void { ::std::free(ptr); }
+auto operator delete[](void* ptr, ::std::nothrow_t const&) noexcept -> void { ::std::free(ptr); }
+auto operator delete(void* ptr, ::std::align_val_t) noexcept -> void { ::std::free(ptr); }
+auto operator delete[](void* ptr, ::std::align_val_t) noexcept -> void { ::std::free(ptr); }
+auto operator delete(void* ptr, ::std::size_t, ::std::align_val_t) noexcept -> void { ::std::free(ptr); }
+auto operator delete[](void* ptr, ::std::size_t, ::std::align_val_t) noexcept -> void { ::std::free(ptr); }
+auto operator delete(void* ptr, ::std::align_val_t, ::std::nothrow_t const&) noexcept -> void { ::std::free(ptr); }
+auto operator delete[](void* ptr, ::std::align_val_t, ::std::nothrow_t const&) noexcept -> void { ::std::free(ptr); }
+
+// ----------------------------------------------------------------------------
+
+TEST_CASE("libevent echo path doesn't allocate", "[libevent_context]")
+{
+    using context = ::stdnet::_Hidden::_Context_base;
+    REQUIRE(memory_functions_set);
+
+    ::stdnet::_Hidden::_Libevent_context libevent;
+    context& ctxt(libevent);
+
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    auto client(ctxt._Make_socket(fds[0], true));
+    auto server(ctxt._Make_socket(fds[1], true));
+
+    char         send_buffer[] = "hello";
+    char         receive_buffer[sizeof(send_buffer)];
+    ::iovec      send_vec{send_buffer, sizeof(send_buffer)};
+    ::iovec      receive_vec{receive_buffer, sizeof(receive_buffer)};
+
+    auto echo = [&]{
+        int count{};
+        test_operation<context::_Receive_operation> receive(&count, server, POLLIN);
+        ::std::get<0>(receive).msg_iov    = &receive_vec;
+        ::std::get<0>(receive).msg_iovlen = 1;
+        test_operation<context::_Send_operation> send(&count, client, POLLOUT);
+        ::std::get<0>(send).msg_iov    = &send_vec;
+        ::std::get<0>(send).msg_iovlen = 1;
+        test_operation<context::_Resume_after_operation> timer(&count);
+        ::std::get<0>(timer) = ::std::chrono::microseconds(1);
+
+        if (!ctxt._Receive(&receive)) receive._Complete();
+        if (!ctxt._Send(&send)) send._Complete();
+        if (!ctxt._Resume_after(&timer)) timer._Complete();
+        while (count < 3 && ctxt.run_one())
+        {
+        }
+        return receive.completed && send.completed && timer.completed;
+    };
+
+    // The first round may allocate, e.g., the backend's event array.
+    REQUIRE(echo());
+
+    ::std::size_t before(allocations);
+    bool          success{true};
+    for (int i{}; i != 1000; ++i)
+    {
+        success = echo() && success;
+    }
+    ::std::size_t after(allocations);
+    REQUIRE(success);
+    REQUIRE(after == before);
+
+    ::std::error_code error;
+    ctxt._Release(client, error);
+    ctxt._Release(server, error);
+    REQUIRE(!error);
+}
@@ -0,0 +1,243 @@
+// test/stdnet/socket.cpp                                             -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+#include <stdnet/socket.hpp>
+#include <stdnet/internet.hpp>
+#include <stdnet/io_context.hpp>
+#include <stdnet/basic_io_context.hpp>
+#include <stdnet/buffer.hpp>
+#include <stdexec/execution.hpp>
+#include <catch2/catch_all.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+    enum class outcome { none, value, error, stopped };
+
+    template <typename Token>
+    struct env
+    {
+        Token token;
+        friend auto tag_invoke(::stdexec::get_stop_token_t, env const& self) noexcept -> Token
+        {
+            return self.token;
+        }
+    };
+
+    template <typename Token>
+    struct receiver
+    {
+        using is_receiver = void;
+        Token                   token;
+        ::std::atomic<outcome>* result;
+
+        friend auto tag_invoke(::stdexec::set_value_t, receiver&& self, ::std::size_t) noexcept -> void
+        {
+            self.result->store(outcome::value);
+        }
+        friend auto tag_invoke(::stdexec::set_error_t, receiver&& self, ::std::error_code) noexcept -> void
+        {
+            self.result->store(outcome::error);
+        }
+        friend auto tag_invoke(::stdexec::set_stopped_t, receiver&& self) noexcept -> void
+        {
+            self.result->store(outcome::stopped);
+        }
+        friend auto tag_invoke(::stdexec::get_env_t, receiver const& self) noexcept -> env<Token>
+        {
+            return {self.token};
+        }
+    };
+
+    // The size of an operation state depends on the receiver, the upstream
+    // sender, and the stop callback. Using a stop token whose callback holds
+    // three pointers next to the function (like a stop source's intrusive
+    // list) and a trivial upstream sender, the size only depends on stdnet.
+    struct fixed_stop_token
+    {
+        template <typename Callback>
+        struct callback_type
+        {
+            void*          source{};
+            callback_type* next{};
+            callback_type* prev{};
+            Callback       callback;
+
+            template <typename Initializer>
+            callback_type(fixed_stop_token, Initializer&& init)
+                : callback(::std::forward<Initializer>(init))
+            {
+            }
+        };
+        auto stop_requested() const noexcept -> bool { return false; }
+        auto stop_possible() const noexcept -> bool { return true; }
+        friend auto operator==(fixed_stop_token, fixed_stop_token) -> bool = default;
+    };
+
+    struct fixed_sender
+    {
+        using is_sender = void;
+        template <typename Receiver>
+        struct state
+        {
+            Receiver receiver;
+            friend auto tag_invoke(::stdexec::start_t, state& self) noexcept -> void
+            {
+                ::stdexec::set_value(::std::move(self.receiver));
+            }
+        };
+        friend auto tag_invoke(::stdexec::get_completion_signatures_t, fixed_sender const&, auto) noexcept
+        {
+            return ::stdexec::completion_signatures<::stdexec::set_value_t()>();
+        }
+        template <typename Receiver>
+        friend auto tag_invoke(::stdexec::connect_t, fixed_sender, Receiver&& r)
+        {
+            return state<::std::remove_cvref_t<Receiver>>{::std::forward<Receiver>(r)};
+        }
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+TEST_CASE("async_receive operation state size", "[socket]")
+{
+    using state = decltype(::stdexec::connect(
+        ::stdnet::async_receive(fixed_sender{},
+                                ::std::declval<::stdnet::ip::tcp::socket&>(),
+                                ::std::declval<::stdnet::mutable_buffer>()),
+        ::std::declval<receiver<fixed_stop_token>>()));
+
+    // Besides the operation, the receiver, the stop callback, and the data
+    // the state holds only the base's vtable pointer, the outstanding
+    // counter, the upstream receiver, and the optional's flag.
+    using data = decltype(::std::declval<state&>()._D_data);
+    static_assert(sizeof(state) <= sizeof(::stdnet::_Hidden::_Context_base::_Receive_operation)
+                                   + sizeof(receiver<fixed_stop_token>)
+                                   + sizeof(state::_Callback)
+                                   + sizeof(data)
+                                   + 4u * sizeof(void*));
+}
+
+TEST_CASE("a stop requested on another thread cancels a posted receive", "[socket]")
+{
+    ::stdnet::io_context context;
+    auto                 ctxt(context.get_scheduler()._Get_context());
+
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    ::stdnet::ip::tcp::socket stream(ctxt, ctxt->_Make_socket(fds[0], false));
+
+    char                           buffer[16];
+    ::stdexec::inplace_stop_source source;
+    ::std::atomic<outcome>         result{outcome::none};
+    auto state(::stdexec::connect(::stdnet::async_receive(stream, ::stdnet::buffer(buffer)),
+                                  receiver<::stdexec::inplace_stop_token>{source.get_token(), &result}));
+
+    // The context belongs to this thread: starting the receive and requesting
+    // the stop on another thread posts both to the context. The receive is
+    // submitted before the cancellation is processed and gets cancelled.
+    ::std::thread([&]{
+        ::stdexec::start(state);
+        source.request_stop();
+    }).join();
+    context.run_for(::std::chrono::seconds(1));
+    REQUIRE(result == outcome::stopped);
+
+    ::close(fds[1]);
+}
+
+TEST_CASE("a stop requested on the thread running a poll_context cancels a receive", "[socket]")
+{
+    ::stdnet::poll_context context;
+    auto                   ctxt(context.get_scheduler()._Get_context());
+
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    ::stdnet::basic_stream_socket<::stdnet::ip::tcp, ::stdnet::poll_context::scheduler_type>
+        stream(ctxt, ctxt->_Make_socket(fds[0], false));
+
+    char                           buffer[16];
+    ::stdexec::inplace_stop_source source;
+    ::std::atomic<outcome>         result{outcome::none};
+    auto state(::stdexec::connect(::stdnet::async_receive(stream, ::stdnet::buffer(buffer)),
+                                  receiver<::stdexec::inplace_stop_token>{source.get_token(), &result}));
+
+    // The scheduler is single-threaded: the counter of outstanding
+    // completions isn't atomic although the stop token is stoppable.
+    static_assert(::std::is_same_v<decltype(state)::_Counter, int>);
+
+    ::stdexec::start(state);
+    context.run_for(::std::chrono::milliseconds(1));
+    REQUIRE(result == outcome::none);
+    source.request_stop();
+    while (result == outcome::none && context.run_one())
+    {
+    }
+    REQUIRE(result == outcome::stopped);
+
+    ::close(fds[1]);
+}
+
+TEST_CASE("async_send_zerocopy falls back to copying sends", "[socket]")
+{
+    ::stdnet::io_context context;
+    auto                 ctxt(context.get_scheduler()._Get_context());
+
+    // Unix domain sockets don't support zero_copy: enabling it fails once and
+    // the socket remembers to send normally.
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    ::stdnet::ip::tcp::socket stream(ctxt, ctxt->_Make_socket(fds[0], false));
+
+    ::stdexec::inplace_stop_source source;
+    for (char const* message: {"hello", "world"})
+    {
+        ::std::atomic<outcome> result{outcome::none};
+        auto state(::stdexec::connect(::stdnet::async_send_zerocopy(stream, ::stdnet::buffer(message, 5u)),
+                                      receiver<::stdexec::inplace_stop_token>{source.get_token(), &result}));
+        ::stdexec::start(state);
+        while (result == outcome::none && context.run_one())
+        {
+        }
+        REQUIRE(result == outcome::value);
+
+        char buffer[8]{};
+        REQUIRE(::read(fds[1], buffer, sizeof(buffer)) == 5);
+        REQUIRE(::std::string(buffer) == message);
+    }
+    REQUIRE(!stream._Zero_copy_enabled());
+
+    ::close(fds[1]);
+}
@@ -0,0 +1,171 @@
+// test/stdnet/timer_wheel.cpp                                        -*-C++-*-
+// ----------------------------------------------------------------------------
+//
+//  Copyright (c) 2024 Dietmar Kuehl http://www.dietmar-kuehl.de
+//
+//  Licensed under the Apache License Version 2.0 with LLVM Exceptions
+//  (the "License"); you may not use this file except in compliance with
+//  the License. You may obtain a copy of the License at
+//
+//    https://llvm.org/LICENSE.txt
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+// ----------------------------------------------------------------------------
+
+#include <stdnet/timer_wheel.hpp>
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <system_error>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+    using clock = ::std::chrono::steady_clock;
+    using ms    = ::std::chrono::milliseconds;
+
+    struct operation
+        : ::stdnet::_Hidden::_Io_base
+    {
+        ::std::size_t index;
+        operation(::std::size_t index): ::stdnet::_Hidden::_Io_base({}, 0), index(index) {}
+        auto _Complete() -> void override {}
+        auto _Error(::std::error_code) -> void override {}
+        auto _Cancel() -> void override {}
+    };
+}
+
+// ----------------------------------------------------------------------------
+
+TEST_CASE("timer wheel expires timers in order", "[timer_wheel]")
+{
+    ::stdnet::_Hidden::_Timer_wheel wheel;
+    auto                            now(clock::now());
+    operation                       op0(0u), op1(1u), op2(2u);
+    ::stdnet::_Hidden::_Timer_node  node0, node1, node2;
+    node0._Op = &op0;
+    node1._Op = &op1;
+    node2._Op = &op2;
+
+    REQUIRE(wheel._Empty());
+    REQUIRE(wheel._Next() == clock::time_point::max());
+
+    wheel._Insert(&node0, now + ms(100));
+    wheel._Insert(&node1, now + ms(10'000));
+    wheel._Insert(&node2, now + ms(5));
+    REQUIRE(wheel._Size() == 3u);
+    REQUIRE(wheel._Next() <= now + ms(6));
+
+    ::std::vector<::std::size_t> expired;
+    auto collect = [&expired](::stdnet::_Hidden::_Io_base* op){
+        expired.push_back(static_cast<operation*>(op)->index);
+    };
+
+    wheel._Expire(now, collect);
+    REQUIRE(expired.empty());
+    wheel._Expire(now + ms(200), collect);
+    ::std::vector<::std::size_t> expected{2u, 0u};
+    REQUIRE(expired == expected);
+    REQUIRE(!node0._Linked());
+    REQUIRE(wheel._Size() == 1u);
+
+    REQUIRE(wheel._Erase(&node1));
+    REQUIRE(!wheel._Erase(&node1));
+    REQUIRE(wheel._Empty());
+    wheel._Expire(now + ms(20'000), collect);
+    REQUIRE(expired.size() == 2u);
+}
+
+TEST_CASE("timer wheel neither loses nor advances timers", "[timer_wheel]")
+{
+    ::stdnet::_Hidden::_Timer_wheel                wheel;
+    auto                                           start(clock::now());
+    constexpr ::std::size_t                        size{1000u};
+    ::std::vector<operation>                       ops;
+    ::std::vector<::stdnet::_Hidden::_Timer_node>  nodes(size);
+    ::std::vector<long>                            due(size, -1);
+    ::std::mt19937                                 rng(42);
+    ops.reserve(size);
+    for (::std::size_t i{}; i != size; ++i)
+    {
+        ops.emplace_back(i);
+        nodes[i]._Op = &ops[i];
+    }
+
+    long now{};
+    bool early{false};
+    for (int step{}; step != 20'000; ++step)
+    {
+        ::std::size_t i(rng() % size);
+        if (due[i] < 0)
+        {
+            // Some timers are beyond the range covered by the wheel.
+            long timeout(rng() % 16 == 0? long(rng() % 20'000'000): long(rng() % 5'000));
+            due[i] = now + timeout;
+            wheel._Insert(&nodes[i], start + ms(due[i]));
+        }
+        else if (rng() % 4 == 0)
+        {
+            REQUIRE(wheel._Erase(&nodes[i]));
+            due[i] = -1;
+        }
+
+        if (step % 8 == 0)
+        {
+            // Jump to the next event every so often to pass long periods.
+            REQUIRE((wheel._Empty() || start + ms(now) < wheel._Next()));
+            long next(::std::chrono::ceil<ms>(wheel._Next() - start).count());
+            now = step % 64 == 0 && !wheel._Empty()? next: now + long(rng() % 50);
+            wheel._Expire(start + ms(now), [&](::stdnet::_Hidden::_Io_base* op){
+                ::std::size_t index(static_cast<operation*>(op)->index);
+                early = early || now < due[index];
+                due[index] = -1;
+            });
+            // Timers may expire up to one tick late.
+            for (long d: due)
+            {
+                REQUIRE((d < 0 || now - 1 <= d));
+            }
+        }
+    }
+    REQUIRE(!early);
+}
+
+TEST_CASE("timer wheel reports the next event after the current time", "[timer_wheel]")
+{
+    ::stdnet::_Hidden::_Timer_wheel wheel;
+    auto                            start(clock::now());
+    operation                       op0(0u), op1(1u);
+    ::stdnet::_Hidden::_Timer_node  node0, node1;
+    node0._Op = &op0;
+    node1._Op = &op1;
+
+    // Both timers end up in the slot of the current block on a higher level,
+    // i.e., they are only moved when the wheel comes around to this slot.
+    long now{101};
+    wheel._Expire(start + ms(now), [](auto){});
+    wheel._Insert(&node0, start + ms(now + 4080));
+    wheel._Insert(&node1, start + ::std::chrono::hours(6));
+
+    bool expired{false};
+    while (!wheel._Empty())
+    {
+        auto next(wheel._Next());
+        REQUIRE(start + ms(now) < next);
+        REQUIRE((expired || next <= start + ms(now + 4080) + ms(1)));
+        now = ::std::chrono::ceil<ms>(next - start).count();
+        wheel._Expire(start + ms(now), [&](::stdnet::_Hidden::_Io_base* op){
+            REQUIRE(static_cast<operation*>(op)->index == (expired? 1u: 0u));
+            expired = true;
+        });
+    }
+    REQUIRE(::std::chrono::hours(6) <= ms(now));
+}